@@ -56,6 +56,21 @@ namespace
 		}
 		// ... Right functions are all UNREACHABLE
 	};
+
+	// records progress, returns true if converged
+	bool ReportAndCheck
+		(Sparse::IterativeStats_* stats,
+		 int iterations,
+		 double residual,
+		 double tol)
+	{
+		if (stats)
+		{
+			stats->iterations_ = iterations;
+			stats->residual_ = residual;
+		}
+		return residual <= tol;
+	}
 }	// leave local
 
 void Sparse::CGSolve
@@ -64,7 +79,9 @@ void Sparse::CGSolve
 	 double tol_rel,
     double tol_abs,
 	 int max_iterations,
-	 Vector_<>* x)
+	 Vector_<>* x,
+	 IterativeStats_* stats,
+	 bool inexact)
 {
 	const int n = A.Size();
 	assert(b.size() == n && x->size() == n);
@@ -87,9 +104,178 @@ void Sparse::CGSolve
 		const double alphaK = beta / InnerProduct(z, p);
 		Transform(x, p, LinearIncrement(alphaK));
 		Transform(&r, z, LinearIncrement(-alphaK));
-		if (sqrt(InnerProduct(r, r)) <= tNorm)
+		const double rNorm = sqrt(InnerProduct(r, r));
+		if (ReportAndCheck(stats, ii + 1, rNorm, tNorm))
+			return;
+	}
+	// the last iterate minimizes the A-norm error over the Krylov space, so is the best we have if an inexact solve is acceptable
+	REQUIRE(inexact, "Exhausted iterations in CGSolve");
+}
+
+void Sparse::BiCGStabSolve
+	(const Sparse::Square_& A,
+	 const Vector_<>& b,
+	 double tol_rel,
+	 double tol_abs,
+	 int max_iterations,
+	 Vector_<>* x,
+	 IterativeStats_* stats,
+	 KrylovWorkspace_* workspace)
+{
+	const int n = A.Size();
+	assert(b.size() == n && x->size() == n);
+	assert((IsPositive(tol_rel) || IsPositive(tol_abs)) && max_iterations > 0);
+
+	const double tNorm = tol_rel * sqrt(InnerProduct(b, b)) + tol_abs;
+	XPrecondition_ precondition(A);
+	KrylovWorkspace_ local;
+	KrylovWorkspace_& w = workspace ? *workspace : local;
+	for (auto v : { &w.r_, &w.rHat_, &w.p_, &w.v_, &w.s_, &w.t_, &w.y_, &w.z_ })
+		v->Resize(n);
+
+	A.MultiplyLeft(*x, &w.r_);
+	Transform(b, w.r_, std::minus<double>(), &w.r_);  // r = b - Ax
+	if (ReportAndCheck(stats, 0, sqrt(InnerProduct(w.r_, w.r_)), tNorm))
+		return;
+	Copy(w.r_, &w.rHat_);
+	double rhoPrev = 1.0, alpha = 1.0, omega = 1.0;
+	for (int ii = 0; ii < max_iterations; ++ii)
+	{
+		const double rho = InnerProduct(w.rHat_, w.r_);
+		REQUIRE(rho != 0.0, "BiCGStab breakdown:  residual is orthogonal to shadow residual");
+		if (ii == 0)
+			Copy(w.r_, &w.p_);
+		else
+		{	// p = r + beta (p - omega v)
+			Transform(&w.p_, w.v_, LinearIncrement(-omega));
+			w.p_ *= (rho / rhoPrev) * (alpha / omega);
+			w.p_ += w.r_;
+		}
+		precondition.Left(w.p_, &w.y_);
+		A.MultiplyLeft(w.y_, &w.v_);
+		alpha = rho / InnerProduct(w.rHat_, w.v_);
+		Copy(w.r_, &w.s_);
+		Transform(&w.s_, w.v_, LinearIncrement(-alpha));
+		Transform(x, w.y_, LinearIncrement(alpha));
+		const double sNorm = sqrt(InnerProduct(w.s_, w.s_));
+		if (ReportAndCheck(stats, ii + 1, sNorm, tNorm))
 			return;
+
+		precondition.Left(w.s_, &w.z_);
+		A.MultiplyLeft(w.z_, &w.t_);
+		const double tt = InnerProduct(w.t_, w.t_);
+		REQUIRE(tt > 0.0, "BiCGStab breakdown:  stabilizing step vanished");
+		omega = InnerProduct(w.t_, w.s_) / tt;
+		REQUIRE(omega != 0.0, "BiCGStab breakdown:  stabilizing step vanished");
+		Transform(x, w.z_, LinearIncrement(omega));
+		Copy(w.s_, &w.r_);
+		Transform(&w.r_, w.t_, LinearIncrement(-omega));
+		if (ReportAndCheck(stats, ii + 1, sqrt(InnerProduct(w.r_, w.r_)), tNorm))
+			return;
+		rhoPrev = rho;
+	}
+	THROW("Exhausted iterations in BiCGStabSolve");
+}
+
+void Sparse::GMRESSolve
+	(const Sparse::Square_& A,
+	 const Vector_<>& b,
+	 int restart,
+	 double tol_rel,
+	 double tol_abs,
+	 int max_iterations,
+	 Vector_<>* x,
+	 IterativeStats_* stats,
+	 KrylovWorkspace_* workspace)
+{
+	const int n = A.Size();
+	assert(b.size() == n && x->size() == n);
+	assert((IsPositive(tol_rel) || IsPositive(tol_abs)) && max_iterations > 0);
+	const int m = Min(restart, n);
+	REQUIRE(m > 0, "GMRES restart length must be positive");
+
+	const double tNorm = tol_rel * sqrt(InnerProduct(b, b)) + tol_abs;
+	XPrecondition_ precondition(A);
+	KrylovWorkspace_ local;
+	KrylovWorkspace_& w = workspace ? *workspace : local;
+	w.basis_.Resize(m + 1);
+	w.hessenberg_.Resize(m);
+	for (auto& v : w.basis_)
+		v.Resize(n);
+	for (auto& h : w.hessenberg_)
+		h.Resize(m + 1);
+	for (auto v : { &w.cos_, &w.sin_, &w.y_ })
+		v->Resize(m);
+	w.g_.Resize(m + 1);
+	w.r_.Resize(n);
+	w.z_.Resize(n);
+
+	int nMultiplies = 0;
+	for (;;)
+	{
+		A.MultiplyLeft(*x, &w.r_);
+		Transform(b, w.r_, std::minus<double>(), &w.r_);  // r = b - Ax
+		const double beta = sqrt(InnerProduct(w.r_, w.r_));
+		if (ReportAndCheck(stats, nMultiplies, beta, tNorm))
+			return;
+		REQUIRE(nMultiplies < max_iterations, "Exhausted iterations in GMRESSolve");
+
+		Transform(w.r_, [&](double r_i) { return r_i / beta; }, &w.basis_[0]);
+		w.g_.Fill(0.0);
+		w.g_[0] = beta;
+		int k = 0;	// dimension of the Krylov space we will use
+		double resid = beta;
+		while (k < m && nMultiplies < max_iterations && resid > tNorm)
+		{
+			precondition.Left(w.basis_[k], &w.z_);
+			Vector_<>& next = w.basis_[k + 1];
+			A.MultiplyLeft(w.z_, &next);
+			++nMultiplies;
+			// modified Gram-Schmidt against the existing basis
+			Vector_<>& h = w.hessenberg_[k];
+			for (int ii = 0; ii <= k; ++ii)
+			{
+				h[ii] = InnerProduct(next, w.basis_[ii]);
+				Transform(&next, w.basis_[ii], LinearIncrement(-h[ii]));
+			}
+			h[k + 1] = sqrt(InnerProduct(next, next));
+			const bool lucky = !IsPositive(h[k + 1] / Max(beta, DA::EPSILON));
+			if (!lucky)
+				next *= 1.0 / h[k + 1];
+			// apply the accumulated Givens rotations to the new column, then eliminate its subdiagonal
+			for (int ii = 0; ii < k; ++ii)
+			{
+				const double temp = w.cos_[ii] * h[ii] + w.sin_[ii] * h[ii + 1];
+				h[ii + 1] = -w.sin_[ii] * h[ii] + w.cos_[ii] * h[ii + 1];
+				h[ii] = temp;
+			}
+			const double rr = sqrt(Square(h[k]) + Square(h[k + 1]));
+			REQUIRE(rr > 0.0, "GMRES breakdown:  singular Hessenberg matrix");
+			w.cos_[k] = h[k] / rr;
+			w.sin_[k] = h[k + 1] / rr;
+			h[k] = rr;
+			h[k + 1] = 0.0;
+			w.g_[k + 1] = -w.sin_[k] * w.g_[k];
+			w.g_[k] *= w.cos_[k];
+			resid = fabs(w.g_[k + 1]);
+			++k;
+			if (lucky)
+				break;
+		}
+
+		// back-substitute for the Krylov coefficients, then x += M^{-1} V y
+		for (int ii = k - 1; ii >= 0; --ii)
+		{
+			double sum = w.g_[ii];
+			for (int jj = ii + 1; jj < k; ++jj)
+				sum -= w.hessenberg_[jj][ii] * w.y_[jj];
+			w.y_[ii] = sum / w.hessenberg_[ii][ii];
+		}
+		w.r_.Fill(0.0);
+		for (int ii = 0; ii < k; ++ii)
+			Transform(&w.r_, w.basis_[ii], LinearIncrement(w.y_[ii]));
+		precondition.Left(w.r_, &w.z_);
+		*x += w.z_;
 	}
-	THROW("Exhausted iterations in CGSolve");
 }
 
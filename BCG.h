@@ -1,8 +1,9 @@
-
 // conjugate and bi-conjugate gradient solvers
 
 #pragma once
 
+#include "Vectors.h"
+
 class HasPreconditioner_
 {
 public:
@@ -16,12 +17,53 @@ namespace Sparse
 {
 	class Square_;
 
+	// convergence report from an iterative solve
+	struct IterativeStats_
+	{
+		int iterations_;
+		double residual_;	// 2-norm of b - Ax at exit, as recomputed by the solver (GMRES does so at each restart)
+		IterativeStats_() : iterations_(0), residual_(0.0) {}
+	};
+
+	// scratch space for the Krylov solvers
+		// holding one of these across many solves of the same size avoids reallocation on every call
+	struct KrylovWorkspace_ : noncopyable
+	{
+		Vector_<> r_, rHat_, p_, v_, s_, t_, y_, z_;
+		Vector_<Vector_<>> basis_, hessenberg_;	// GMRES only; hessenberg_ is stored by columns
+		Vector_<> cos_, sin_, g_;
+	};
+
 	void CGSolve
 		(const Sparse::Square_& A,
 		 const Vector_<>& b,
 		 double tol_rel,
        double tol_abs,
 		 int max_iterations,
-		 Vector_<>* x);
+		 Vector_<>* x,
+		 IterativeStats_* stats = nullptr,
+		 bool inexact = false);	// if set, exhausting max_iterations leaves the last iterate in x rather than throwing
+
+	// for non-symmetric A; all use A's preconditioner, if it has one, on the right
+	void BiCGStabSolve
+		(const Sparse::Square_& A,
+		 const Vector_<>& b,
+		 double tol_rel,
+		 double tol_abs,
+		 int max_iterations,
+		 Vector_<>* x,
+		 IterativeStats_* stats = nullptr,
+		 KrylovWorkspace_* workspace = nullptr);
+
+	void GMRESSolve
+		(const Sparse::Square_& A,
+		 const Vector_<>& b,
+		 int restart,	// Krylov subspace dimension between restarts
+		 double tol_rel,
+		 double tol_abs,
+		 int max_iterations,	// counts matrix multiplies, not restarts
+		 Vector_<>* x,
+		 IterativeStats_* stats = nullptr,
+		 KrylovWorkspace_* workspace = nullptr);
 }
 
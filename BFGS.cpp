@@ -1,6 +1,7 @@
 
 #include "Platform.h"
 #include "BFGS.h"
+#include <atomic>
 #include "Strict.h"
 
 #include "Functionals.h"
@@ -9,6 +10,8 @@
 #include "Vectors.h"
 #include "Exceptions.h"
 #include "CellUtils.h"
+#include "Parallel.h"
+#include "QuasiRandom.h"
 
 #include "MG_LinesearchMethod_Enum.inc"
 #include "MG_BFGSControls_Object.inc"
@@ -98,6 +101,20 @@ void BFGS::Minimize
 	double fxown;
 	double& fx = fx_final ? *fx_final : fxown;
 
+	// copies of func for the speculative trials of a backtracking line search, made once rather than at every iteration
+	Vector_<std::unique_ptr<BFGS::Func_>> clones;
+	Vector_<const BFGS::Func_*> funcs(1, &func);
+	if (param.linesearch_.Switch() != LinesearchMethod_::Value_::MORE_THUENTE)
+	{
+		while (funcs.size() < Min(param.speculative_steps_, param.max_linesearch_))
+		{
+			clones.emplace_back(func.Clone());
+			if (!clones.back())
+				break;
+			funcs.push_back(clones.back().get());
+		}
+	}
+
 	fx = func(*x, &g, 0.0);
 
 	// Store the initial value of the objective function. 
@@ -128,7 +145,7 @@ void BFGS::Minimize
 			SetInScope_<Vector_<>> saveX(x);
 
 			// Search for an optimal step.
-			ls = param.linesearch_.LineSearch(x, &fx, &g, d, &step, xp, gp, func, param);
+			ls = param.linesearch_.LineSearch(x, &fx, &g, d, &step, xp, gp, funcs, param);
 			assert(ls >= 0);	// should throw otherwise
 			saveX.release();
 		}
@@ -218,7 +235,7 @@ static int line_search_backtracking
 	double* stp,
 	const Vector_<>& xp,
 	const Vector_<>& gp,
-	const BFGS::Func_& func,
+	const Vector_<const BFGS::Func_*>& funcs,	// the function, then any copies for speculative trials
 	const BFGSControls_& param)
 {
 	static const double DEC = 0.5, INC = 2.1;
@@ -234,38 +251,67 @@ static int line_search_backtracking
 	const double finit = *f;
 	const double dgtest = param.ftol_ * dginit;
 
-	for (int count = 1; ; ++count) 
+	// we evaluate the next few trials of the decreasing branch concurrently, then replay them in order
+		// trials after one which increases the step are discarded, so the search visits the same steps as a serial one
+	Vector_<Vector_<>> xs, gs;
+	Vector_<> fs, steps;
+	for (int count = 1; ; ) 
 	{
-		Transform(xp, s, LinearIncrement(*stp), x);
-		*f = func(*x, g, *stp);
+		const int nUse = Max(1, Min(funcs.size(), param.max_linesearch_ - count + 1));
+		steps.Resize(nUse);
+		steps[0] = *stp;
+		for (int k = 1; k < nUse; ++k)
+			steps[k] = steps[k - 1] * DEC;
+		xs.Resize(nUse);
+		gs.Resize(nUse);
+		for (int k = 0; k < nUse; ++k)
+		{
+			xs[k].Resize(xp.size());
+			gs[k].Resize(g->size());
+		}
+		fs.Resize(nUse);
+		Parallel::For(nUse, [&](int k)
+		{
+			Transform(xp, s, LinearIncrement(steps[k]), &xs[k]);
+			fs[k] = (*funcs[k])(xs[k], &gs[k], steps[k]);
+		});
 
-		double width = DEC;
-		if (*f <= finit + *stp * dgtest) 
+		bool onPath = true;
+		for (int k = 0; k < nUse && onPath; ++k, ++count)
 		{
-			// The sufficient decrease condition (Armijo condition)
-			if (param.linesearch_ == LinesearchMethod_::Value_::ARMIJO) 
-				return count; // Exit with the Armijo condition. 
-
-			/* Check the Wolfe condition. */
-			const double dg = InnerProduct(*g, s);
-			if (dg < param.wolfe_ * dginit) 
-				width = INC;
-			else 
-			{
-				if (param.linesearch_ == LinesearchMethod_::Value_::WOLFE) 
-					return count;	// Exit with the regular Wolfe condition.
+			x->Swap(&xs[k]);
+			g->Swap(&gs[k]);
+			*f = fs[k];
 
-				/* Check the strong Wolfe condition. */
-				if (dg <= -param.wolfe_ * dginit) 
-					return count;	// Exit with the strong Wolfe condition.
+			double width = DEC;
+			if (*f <= finit + *stp * dgtest) 
+			{
+				// The sufficient decrease condition (Armijo condition)
+				if (param.linesearch_ == LinesearchMethod_::Value_::ARMIJO) 
+					return count; // Exit with the Armijo condition. 
+
+				/* Check the Wolfe condition. */
+				const double dg = InnerProduct(*g, s);
+				if (dg < param.wolfe_ * dginit) 
+					width = INC;
+				else 
+				{
+					if (param.linesearch_ == LinesearchMethod_::Value_::WOLFE) 
+						return count;	// Exit with the regular Wolfe condition.
+
+					/* Check the strong Wolfe condition. */
+					if (dg <= -param.wolfe_ * dginit) 
+						return count;	// Exit with the strong Wolfe condition.
+				}
 			}
-		}
 
-		REQUIRE(*stp >= param.min_step_, "Step too small in L-BFGS");
-		REQUIRE(*stp <= param.max_step_, "Step too large in L-BFGS");
-		REQUIRE(count < param.max_linesearch_, "Exhausted iterations in linesearch");
+			REQUIRE(*stp >= param.min_step_, "Step too small in L-BFGS");
+			REQUIRE(*stp <= param.max_step_, "Step too large in L-BFGS");
+			REQUIRE(count < param.max_linesearch_, "Exhausted iterations in linesearch");
 
-		*stp *= width;
+			*stp *= width;
+			onPath = width == DEC;
+		}
 	}
 }
 
@@ -420,17 +466,17 @@ int LinesearchMethod_::LineSearch
 	 double* stp, 
 	 const Vector_<>& xp, 
 	 const Vector_<>& gp, 
-	 const BFGS::Func_& func, 
+	 const Vector_<const BFGS::Func_*>& funcs, 
 	 const BFGSControls_& controls) 
 const
 {
 	switch (Switch())
 	{
 	case LinesearchMethod_::Value_::MORE_THUENTE:
-		return line_search_morethuente(x, f, g, s, stp, xp, gp, func, controls);
+		return line_search_morethuente(x, f, g, s, stp, xp, gp, *funcs[0], controls);
 	default:
 		assert(*this == controls.linesearch_);	// backtracking linesearch switches on method in controls
-		return line_search_backtracking(x, f, g, s, stp, xp, gp, func, controls);
+		return line_search_backtracking(x, f, g, s, stp, xp, gp, funcs, controls);
 	}
 }
 
@@ -731,3 +777,118 @@ static void update_trial_interval(
 
 
 
+// multi-start driver
+
+namespace
+{
+	// forwards to the user's function, and halts a start once it is dominated by the best objective seen so far
+	class XStartFunc_ : public BFGS::Func_
+	{
+		std::unique_ptr<const BFGS::Func_> own_;	// for clones
+		const BFGS::Func_& func_;
+		std::atomic<double>* best_;
+		double margin_;
+		int minIterations_;
+	public:
+		mutable bool abandoned_;
+		XStartFunc_
+			(const BFGS::Func_& func,
+			 const BFGS::Func_* own,
+			 std::atomic<double>* best,
+			 double margin,
+			 int min_iterations)
+			: own_(own), func_(func), best_(best), margin_(margin), minIterations_(min_iterations), abandoned_(false) {}
+
+		double operator()(const Vector_<>& x, Vector_<>* g, double step) const override
+		{
+			return func_(x, g, step);
+		}
+		bool CheckHalt
+			(const Vector_<>& x,
+			 const Vector_<>& g,
+			 double fx,
+			 double xnorm,
+			 double gnorm,
+			 double step,
+			 int k,
+			 int ls)
+		const override
+		{
+			if (func_.CheckHalt(x, g, fx, xnorm, gnorm, step, k, ls))
+				return true;
+			// every iterate of every start bounds the best minimum from above
+			double best = best_->load();
+			while (fx < best && !best_->compare_exchange_weak(best, fx));
+			abandoned_ = k >= minIterations_ && fx > best + margin_ * Max(1.0, fabs(best));
+			return abandoned_;
+		}
+		BFGS::Func_* Clone() const override
+		{
+			const BFGS::Func_* copy = func_.Clone();
+			return copy ? new XStartFunc_(*copy, copy, best_, margin_, minIterations_) : nullptr;
+		}
+	};
+}	// leave local
+
+int BFGS::MultiStart
+	(const Vector_<Vector_<>>& starts,
+	 const Func_& func,
+	 const BFGSControls_& controls,
+	 Vector_<StartResult_>* results,
+	 double abandon_margin,
+	 int min_iterations)
+{
+	const int n = starts.size();
+	REQUIRE(n > 0, "No starting points for multi-start minimization");
+	REQUIRE(abandon_margin >= 0.0, "Abandonment margin must be non-negative");
+	results->Resize(n);
+	std::atomic<double> best(DA::INFINITY);
+	// each thread needs its own copy of func; without one, the starts run serially on the original
+	const bool parallel = n > 1 && Parallel::NumThreads() > 1 && std::unique_ptr<Func_>(func.Clone());
+	Parallel::For(n, [&](int ii)
+	{
+		const Func_* copy = parallel ? func.Clone() : nullptr;
+		REQUIRE(copy || !parallel, "Function clone failed in multi-start minimization");
+		XStartFunc_ f(copy ? *copy : func, copy, &best, abandon_margin, min_iterations);
+		StartResult_& r = (*results)[ii];
+		r.x_ = starts[ii];
+		try
+		{
+			Minimize(&r.x_, f, controls, &r.fx_);
+			r.status_ = f.abandoned_ ? StartResult_::Status_::ABANDONED : StartResult_::Status_::FINISHED;
+		}
+		catch (std::exception&)
+		{
+			r.status_ = StartResult_::Status_::FAILED;
+			r.x_ = starts[ii];
+			r.fx_ = DA::INFINITY;
+		}
+	}, parallel ? 0 : 1);
+
+	int retval = -1;
+	for (int ii = 0; ii < n; ++ii)
+		if ((*results)[ii].status_ != StartResult_::Status_::FAILED && (retval < 0 || (*results)[ii].fx_ < (*results)[retval].fx_))
+			retval = ii;
+	REQUIRE(retval >= 0, "All starts failed in multi-start minimization");
+	return retval;
+}
+
+Vector_<Vector_<>> BFGS::BoxStarts
+	(const Vector_<>& lower,
+	 const Vector_<>& upper,
+	 int n_starts,
+	 QuasiRandom::SequenceSet_* sequence)
+{
+	const int n = lower.size();
+	REQUIRE(upper.size() == n, "Box bounds must have the same size");
+	REQUIRE(sequence && sequence->Size() == n, "Quasi-random sequence must have the dimension of the box");
+	Vector_<Vector_<>> retval(n_starts, lower);
+	Vector_<> u;
+	for (auto& x : retval)
+	{
+		sequence->Next(&u);
+		for (int ii = 0; ii < n; ++ii)
+			x[ii] += u[ii] * (upper[ii] - lower[ii]);
+	}
+	return retval;
+}
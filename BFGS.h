@@ -15,11 +15,16 @@
 #include "Strict.h"
 
 #include "Strings.h"
+#include "Vectors.h"
 namespace BFGS
 {
 	class Func_;
 }
 struct BFGSControls_;
+namespace QuasiRandom
+{
+	class SequenceSet_;
+}
 
 /*IF--------------------------------------------------------------------------
 enumeration LinesearchMethod
@@ -36,7 +41,7 @@ alternative WOLFE
 alternative STRONG_WOLFE
 	Finds the step length such that it satisfies both the Armijo condition and the following
 	condition,  - |g(x + a * d)^T d| <= BFGSControls_::wolfe * |g(x)^T d|
-method int LineSearch(Vector_<>* x, double* f, Vector_<>* g, const Vector_<>& s, double* stp, const Vector_<>& xp, const Vector_<>& gp, const BFGS::Func_& func, const BFGSControls_& controls) const;
+method int LineSearch(Vector_<>* x, double* f, Vector_<>* g, const Vector_<>& s, double* stp, const Vector_<>& xp, const Vector_<>& gp, const Vector_<const BFGS::Func_*>& funcs, const BFGSControls_& controls) const;
 -IF-------------------------------------------------------------------------*/
 
 #include "MG_LinesearchMethod_Enum.h"
@@ -77,6 +82,9 @@ gtol is number default 0.9
 	evaluations are fast, a smaller value (e.g. 0.1) may be used.
 halt_on_stall is boolean default false
 	If true, allow underflow of step
+speculative_steps is integer default 1
+	Number of trial steps of the backtracking line searches which are evaluated concurrently.
+	Needs a function which supports Clone; copies are made once per minimization.  Does not affect the More-Thuente search
 &conditions
 m_ >= 3
 epsilon_ > 0
@@ -86,6 +94,7 @@ max_iterations_ >= 0
 ftol_ > 0.0 && ftol_ < 0.5
 wolfe_ > ftol_ && wolfe_ < 1.0
 gtol_ > ftol_ && gtol_ < 1.0
+speculative_steps_ >= 1
 -IF-------------------------------------------------------------------------*/
 
 #include "MG_BFGSControls_Object.h"
@@ -119,6 +128,10 @@ namespace BFGS
 		{
 			return false;
 		}
+
+		// speculative line searches and parallel multi-start give each thread its own copy
+			// otherwise (the default) operator() is only ever called from one thread at a time
+		virtual Func_* Clone() const { return nullptr; }
 	};
 
 	void Minimize
@@ -126,5 +139,31 @@ namespace BFGS
 		 const Func_& func,
 		 const BFGSControls_& controls,
 		 double* fx = 0);		// for optional output of f(x) at minimum
-}
 
+	// outcome of one start of MultiStart
+	struct StartResult_
+	{
+		enum class Status_ { FINISHED, ABANDONED, FAILED } status_;
+		Vector_<> x_;	// the minimizing point if FINISHED, the last iterate if ABANDONED, the start if FAILED
+		double fx_;	// DA::INFINITY if FAILED
+	};
+
+	// runs Minimize from each start, returning the index of the best result
+		// starts run concurrently on the shared thread pool if func supports Clone, else one at a time
+		// a start is abandoned once, after min_iterations, its objective exceeds the best seen by any start by abandon_margin * max(1, |best|)
+		// a start which throws is recorded as FAILED; we only throw if all of them fail
+	int MultiStart
+		(const Vector_<Vector_<>>& starts,
+		 const Func_& func,
+		 const BFGSControls_& controls,
+		 Vector_<StartResult_>* results,
+		 double abandon_margin = DA::INFINITY,
+		 int min_iterations = 5);
+
+	// n_starts points in the box [lower, upper], from a quasi-random sequence of the same dimension
+	Vector_<Vector_<>> BoxStarts
+		(const Vector_<>& lower,
+		 const Vector_<>& upper,
+		 int n_starts,
+		 QuasiRandom::SequenceSet_* sequence);
+}
@@ -0,0 +1,193 @@
+
+#include "Platform.h"
+#include "BlockDiagonal.h"
+#include "Strict.h"
+
+#include "Sparse.h"
+#include "Algorithms.h"
+#include "Exceptions.h"
+#include "Parallel.h"
+
+namespace
+{
+	static const double ZERO = 0.0;	// used for off-block matrix elements
+
+	// layout of the blocks, and the order in which to schedule them
+	struct BlockLayout_
+	{
+		Vector_<int> offsets_;	// start of each block, plus the total size at the back
+		Vector_<int> order_;	// largest blocks first, so dynamic claiming balances uneven work
+
+		template<class B_> BlockLayout_(const Vector_<B_>& blocks)
+		{
+			offsets_.push_back(0);
+			for (const auto& b : blocks)
+				offsets_.push_back(offsets_.back() + b->Size());
+			order_ = Vector::UpTo(blocks.size());
+			std::stable_sort(order_.begin(), order_.end(), [&](int i, int j) { return blocks[i]->Size() > blocks[j]->Size(); });
+		}
+		int Size() const { return offsets_.back(); }
+		int Blocks() const { return offsets_.size() - 1; }
+		int BlockSize(int i_block) const { return offsets_[i_block + 1] - offsets_[i_block]; }
+		// index of the block containing i_row
+		int Locate(int i_row) const
+		{
+			assert(i_row >= 0 && i_row < Size());
+			return static_cast<int>(UpperBound(offsets_, i_row) - offsets_.begin()) - 1;
+		}
+
+		// applies op(i_block, x_block, &b_block) to every block in parallel
+		template<class OP_> void ForEach
+			(const Vector_<>& x,
+			 Vector_<>* b,
+			 const OP_& op)
+		const
+		{
+			assert(x.size() == Size());
+			b->Resize(Size());
+			Parallel::For(Blocks(), [&](int i_task)
+			{
+				const int ib = order_[i_task];
+				Vector_<> xi(x.begin() + offsets_[ib], x.begin() + offsets_[ib + 1]), bi;
+				op(ib, xi, &bi);
+				assert(bi.size() == BlockSize(ib));
+				std::copy(bi.begin(), bi.end(), b->begin() + offsets_[ib]);
+			});
+		}
+	};
+
+	template<class D_> Vector_<>::const_iterator BlockMakeCorrelated
+		(const BlockLayout_& layout,
+		 const Vector_<std::unique_ptr<D_>>& blocks,
+		 Vector_<>::const_iterator iid_begin,
+		 Vector_<>* correlated)
+	{	// serial, since the blocks consume iid's in sequence
+		correlated->Resize(layout.Size());
+		Vector_<> ci;
+		for (int ib = 0; ib < layout.Blocks(); ++ib)
+		{
+			iid_begin = blocks[ib]->MakeCorrelated(iid_begin, &ci);
+			std::copy(ci.begin(), ci.end(), correlated->begin() + layout.offsets_[ib]);
+		}
+		return iid_begin;
+	}
+
+	class BlockDecomp_ : public SquareMatrixDecomposition_
+	{
+		BlockLayout_ layout_;
+		Vector_<std::unique_ptr<SquareMatrixDecomposition_>> blocks_;
+
+		void XMultiplyLeft_af(const Vector_<>& x, Vector_<>* b) const override
+		{
+			layout_.ForEach(x, b, [&](int ib, const Vector_<>& xi, Vector_<>* bi) { blocks_[ib]->MultiplyLeft(xi, bi); });
+		}
+		void XMultiplyRight_af(const Vector_<>& x, Vector_<>* b) const override
+		{
+			layout_.ForEach(x, b, [&](int ib, const Vector_<>& xi, Vector_<>* bi) { blocks_[ib]->MultiplyRight(xi, bi); });
+		}
+		void XSolveLeft_af(const Vector_<>& b, Vector_<>* x) const override
+		{
+			layout_.ForEach(b, x, [&](int ib, const Vector_<>& bi, Vector_<>* xi) { blocks_[ib]->SolveLeft(bi, xi); });
+		}
+		void XSolveRight_af(const Vector_<>& b, Vector_<>* x) const override
+		{
+			layout_.ForEach(b, x, [&](int ib, const Vector_<>& bi, Vector_<>* xi) { blocks_[ib]->SolveRight(bi, xi); });
+		}
+	public:
+		BlockDecomp_(const BlockLayout_& layout, Vector_<std::unique_ptr<SquareMatrixDecomposition_>>* blocks) : layout_(layout) { blocks_.Swap(blocks); }
+		int Size() const override { return layout_.Size(); }
+	};
+
+	class BlockDecompSymm_ : public Sparse::SymmetricDecomposition_
+	{
+		BlockLayout_ layout_;
+		Vector_<std::unique_ptr<SymmetricMatrixDecomposition_>> blocks_;
+
+		void XMultiply_af(const Vector_<>& x, Vector_<>* b) const override
+		{
+			layout_.ForEach(x, b, [&](int ib, const Vector_<>& xi, Vector_<>* bi) { blocks_[ib]->Multiply(xi, bi); });
+		}
+		void XSolve_af(const Vector_<>& b, Vector_<>* x) const override
+		{
+			layout_.ForEach(b, x, [&](int ib, const Vector_<>& bi, Vector_<>* xi) { blocks_[ib]->Solve(bi, xi); });
+		}
+	public:
+		BlockDecompSymm_(const BlockLayout_& layout, Vector_<std::unique_ptr<SymmetricMatrixDecomposition_>>* blocks) : layout_(layout) { blocks_.Swap(blocks); }
+		int Size() const override { return layout_.Size(); }
+		int Rank() const override
+		{
+			int retval = 0;
+			for (const auto& b : blocks_)
+				retval += b->Rank();
+			return retval;
+		}
+		Vector_<>::const_iterator MakeCorrelated
+			(Vector_<>::const_iterator iid_begin,
+			 Vector_<>* correlated)
+		const override
+		{
+			return BlockMakeCorrelated(layout_, blocks_, iid_begin, correlated);
+		}
+	};
+
+	class BlockDiagonal_ : public Sparse::Square_
+	{
+		Vector_<Handle_<Sparse::Square_>> blocks_;
+		BlockLayout_ layout_;
+	public:
+		BlockDiagonal_(const Vector_<Handle_<Sparse::Square_>>& blocks) : blocks_(blocks), layout_(blocks) {}
+
+		int Size() const override { return layout_.Size(); }
+		void MultiplyLeft(const Vector_<>& x, Vector_<>* b) const override
+		{
+			layout_.ForEach(x, b, [&](int ib, const Vector_<>& xi, Vector_<>* bi) { blocks_[ib]->MultiplyLeft(xi, bi); });
+		}
+		void MultiplyRight(const Vector_<>& x, Vector_<>* b) const override
+		{
+			layout_.ForEach(x, b, [&](int ib, const Vector_<>& xi, Vector_<>* bi) { blocks_[ib]->MultiplyRight(xi, bi); });
+		}
+		bool IsSymmetric() const override
+		{
+			return AllOf(blocks_, [](const Handle_<Sparse::Square_>& b) { return b->IsSymmetric(); });
+		}
+
+		SquareMatrixDecomposition_* Decompose() const override
+		{
+			NOTE("Decomposing block-diagonal matrix");
+			const int nb = blocks_.size();
+			Vector_<std::unique_ptr<SquareMatrixDecomposition_>> decomps(nb);
+			Parallel::For(nb, [&](int i_task)
+			{
+				const int ib = layout_.order_[i_task];
+				decomps[ib].reset(blocks_[ib]->Decompose());
+			});
+
+			if (!AllOf(decomps, [](const std::unique_ptr<SquareMatrixDecomposition_>& d) { return !!dynamic_cast<SymmetricMatrixDecomposition_*>(d.get()); }))
+				return new BlockDecomp_(layout_, &decomps);
+			Vector_<std::unique_ptr<SymmetricMatrixDecomposition_>> symm(nb);
+			for (int ib = 0; ib < nb; ++ib)
+				symm[ib].reset(static_cast<SymmetricMatrixDecomposition_*>(decomps[ib].release()));
+			return new BlockDecompSymm_(layout_, &symm);
+		}
+
+		const double& operator()(int i_row, int i_col) const override
+		{
+			const int ib = layout_.Locate(i_row);
+			const int start = layout_.offsets_[ib];
+			if (i_col < start || i_col >= layout_.offsets_[ib + 1])
+				return ZERO;
+			return (*blocks_[ib])(i_row - start, i_col - start);
+		}
+		void Set(int i_row, int i_col, double val) override
+		{
+			THROW("Block-diagonal matrix is immutable; set elements of the blocks before combining them");
+		}
+	};
+}	// leave local
+
+Sparse::Square_* Sparse::NewBlockDiagonal
+	(const Vector_<Handle_<Square_>>& blocks)
+{
+	REQUIRE(!blocks.empty(), "Block-diagonal matrix needs at least one block");
+	return new BlockDiagonal_(blocks);
+}
@@ -11,13 +11,7 @@ Date_ Libor::StartFromFix(const Ccy_& ccy, const Date_& fix_date)
 {
 	const Holidays_& hols = Ccy::Conventions::LiborFixHolidays()(ccy);
 	const int nDays = Ccy::Conventions::LiborFixDays()(ccy);
-	if (nDays == 0)
-		return Holidays::NextBus(hols, fix_date);
-	// normal case -- increment, go to business day
-	Date_ retval = fix_date;
-	for (int ii = 0; ii < nDays; ++ii)
-		retval = Holidays::NextBus(hols, retval.AddDays(1));
-	return retval;
+	return Holidays::AddBus(hols, fix_date, nDays);
 }
 
 namespace
@@ -28,10 +22,7 @@ namespace
 		const int nDays = Ccy::Conventions::LiborFixDays()(ccy);
 		if (nDays == 0)
 			return Holidays::PrevBus(hols, start);
-		Date_ retval = start;
-		for (int ii = 0; ii < nDays; ++ii)
-			retval = Holidays::PrevBus(hols, retval.AddDays(-1));
-		return retval;
+		return Holidays::AddBus(hols, start, -nDays);
 	}
 }	// leave local
 
@@ -15,6 +15,8 @@ const												\
 		imp(x, b);									\
 }
 
+COPY_ALIAS_AND_FORWARD(SquareMatrixDecomposition_, MultiplyLeft, XMultiplyLeft_af)
+COPY_ALIAS_AND_FORWARD(SquareMatrixDecomposition_, MultiplyRight, XMultiplyRight_af)
 COPY_ALIAS_AND_FORWARD(SquareMatrixDecomposition_, SolveLeft, XSolveLeft_af)
 COPY_ALIAS_AND_FORWARD(SquareMatrixDecomposition_, SolveRight, XSolveRight_af)
 COPY_ALIAS_AND_FORWARD(SymmetricMatrixDecomposition_, Multiply, XMultiply_af)
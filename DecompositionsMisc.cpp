@@ -97,6 +97,85 @@ namespace
 			}
 		}
 	};
+
+	// PA = LU with partial pivoting, stored in place:  L (unit diagonal) below the diagonal, U on and above it
+	struct LU_ : SquareMatrixDecomposition_
+	{
+		SquareMatrix_<> src_, lu_;
+		Vector_<int> perm_;	// row perm_[ii] of A is row ii of PA
+
+		LU_(const SquareMatrix_<>& src) : src_(src), lu_(src)
+		{
+			const int n = src.Rows();
+			for (int ii = 0; ii < n; ++ii)
+				perm_.push_back(ii);
+			for (int jj = 0; jj < n; ++jj)
+			{
+				int pivot = jj;
+				for (int ii = jj + 1; ii < n; ++ii)
+					if (fabs(lu_(ii, jj)) > fabs(lu_(pivot, jj)))
+						pivot = ii;
+				REQUIRE(!IsZero(lu_(pivot, jj)), "Singular matrix in LU decomposition");
+				if (pivot != jj)
+				{
+					std::swap_ranges(lu_.Row(jj).begin(), lu_.Row(jj).end(), lu_.Row(pivot).begin());
+					std::swap(perm_[jj], perm_[pivot]);
+				}
+				for (int ii = jj + 1; ii < n; ++ii)
+				{
+					const double m = lu_(ii, jj) /= lu_(jj, jj);
+					for (int kk = jj + 1; kk < n; ++kk)
+						lu_(ii, kk) -= m * lu_(jj, kk);
+				}
+			}
+		}
+
+		int Size() const override { return lu_.Rows(); }
+
+		void XMultiplyLeft_af(const Vector_<>& x, Vector_<>* b) const override
+		{
+			const int n = Size();
+			b->Resize(n);
+			for (int ii = 0; ii < n; ++ii)
+				(*b)[ii] = std::inner_product(x.begin(), x.end(), src_.Row(ii).begin(), 0.0);
+		}
+		void XMultiplyRight_af(const Vector_<>& x, Vector_<>* b) const override
+		{
+			const int n = Size();
+			b->Resize(n);
+			for (int ii = 0; ii < n; ++ii)
+				(*b)[ii] = std::inner_product(x.begin(), x.end(), src_.Col(ii).begin(), 0.0);
+		}
+		void XSolveLeft_af(const Vector_<>& b, Vector_<>* x) const override
+		{
+			NOTICE("Left-solve by LU");
+			const int n = Size();
+			x->Resize(n);
+			for (int ii = 0; ii < n; ++ii)
+				(*x)[ii] = -inner_product(x->begin(), x->begin() + ii, lu_.Row(ii).begin(), -b[perm_[ii]]);
+			for (int ii = n - 1; ii >= 0; --ii)
+			{
+				const double residual = -inner_product(x->begin() + ii + 1, x->end(), lu_.Row(ii).begin() + ii + 1, -(*x)[ii]);
+				(*x)[ii] = residual / lu_(ii, ii);
+			}
+		}
+		void XSolveRight_af(const Vector_<>& b, Vector_<>* x) const override
+		{
+			NOTICE("Right-solve by LU");
+			const int n = Size();
+			Vector_<> w(n);
+			for (int ii = 0; ii < n; ++ii)
+			{
+				const double residual = -inner_product(w.begin(), w.begin() + ii, lu_.Col(ii).begin(), -b[ii]);
+				w[ii] = residual / lu_(ii, ii);
+			}
+			for (int ii = n - 1; ii >= 0; --ii)
+				w[ii] = -inner_product(w.begin() + ii + 1, w.end(), lu_.Col(ii).begin() + ii + 1, -w[ii]);
+			x->Resize(n);
+			for (int ii = 0; ii < n; ++ii)
+				(*x)[perm_[ii]] = w[ii];
+		}
+	};
 }
 
 SymmetricMatrixDecomposition_* DiagonalAsDecomposition
@@ -111,3 +190,9 @@ SquareMatrixDecomposition_* LowerTriangularAsDecomposition
 	return new LowerTriangular_(elements);
 }
 
+SquareMatrixDecomposition_* LUAsDecomposition
+	(const SquareMatrix_<>& src)
+{
+	return new LU_(src);
+}
+
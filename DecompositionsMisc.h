@@ -10,3 +10,6 @@ SymmetricMatrixDecomposition_* DiagonalAsDecomposition
 	(const Vector_<>& diag);
 SquareMatrixDecomposition_* LowerTriangularAsDecomposition
 	(const SquareMatrix_<>& src);
+// general square matrix, by Gaussian elimination with partial pivoting
+SquareMatrixDecomposition_* LUAsDecomposition
+	(const SquareMatrix_<>& src);
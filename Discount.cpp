@@ -4,6 +4,57 @@
 #include "Strict.h"
 
 #include "Vectors.h"
+#include "Algorithms.h"
+#include "Date.h"
 
 DiscountCurve_::DiscountCurve_(const String_& name) : YCComponent_("DiscountCurve", name) {}
 
+// immutable once built; a wider grid replaces it, so readers never need a lock
+struct DiscountCurve_::Grid_
+{
+	Date_ start_;
+	Vector_<> df_;	// df_[i] is the discount factor from start_ to start_ + i days
+
+	Grid_(const DiscountCurve_& curve, const Date_& start, const Date_& end)
+		: start_(start), df_(end - start + 1)
+	{
+		Date_ dt = start;
+		for (auto& d : df_)
+		{
+			d = curve(start_, dt);
+			++dt;
+		}
+	}
+	bool Covers(const Date_& lo, const Date_& hi) const { return start_ <= lo && hi - start_ < df_.size(); }
+	double operator[](const Date_& dt) const { return df_[dt - start_]; }
+};
+
+Vector_<> DiscountCurve_::DFs
+	(const Date_& from,
+	 const Vector_<Date_>& to,
+	 bool sorted)
+const
+{
+	static const int PAD_DAYS = 366;	// extend the grid a little beyond the request, so nearby requests reuse it
+	Vector_<> retval(to.size());
+	if (to.empty())
+		return retval;
+	Date_ lo = sorted ? to.front() : *MinElement(to), hi = sorted ? to.back() : *MaxElement(to);
+	lo = Min(lo, from);
+	hi = Max(hi, from);
+
+	auto grid = std::atomic_load(&grid_);
+	if (!grid || !grid->Covers(lo, hi))
+	{
+		if (grid)
+		{
+			lo = Min(lo, grid->start_);
+			hi = Max(hi, grid->start_.AddDays(grid->df_.size() - 1));
+		}
+		grid.reset(new Grid_(*this, lo, hi.AddDays(Min(PAD_DAYS, Max(0, Date::Maximum() - hi)))));	// padding must not run past the last representable date
+		std::atomic_store(&grid_, grid);
+	}
+	const double scale = 1.0 / (*grid)[from];
+	Transform(to, [&](const Date_& dt) { return scale * (*grid)[dt]; }, &retval);
+	return retval;
+}
@@ -1,4 +1,3 @@
-
 // discount curves just compute discount factors
 
 #pragma once
@@ -9,8 +8,17 @@ class Date_;
 
 class DiscountCurve_ : public YCComponent_
 {
+	struct Grid_;
+	mutable std::shared_ptr<const Grid_> grid_;	// daily discount factors, built on demand and extended as needed
 public:
 	DiscountCurve_(const String_& name);
 	virtual double operator()(const Date_& from, const Date_& to) const = 0;
+	// discount factors from one date to many; each is a lookup in a cached daily grid
+		// assumes DF(a, c) = DF(a, b) DF(b, c), as for any curve which is not itself path-dependent
+		// named, not an operator() overload, so that derived classes overriding the scalar operator() do not hide it
+	Vector_<> DFs
+		(const Date_& from,
+		 const Vector_<Date_>& to,
+		 bool sorted = false)	// if set, the grid range is read from the ends of to
+	const;
 };
-
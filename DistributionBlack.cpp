@@ -7,6 +7,7 @@
 #include "OptionType.h"
 #include "Exceptions.h"
 #include "Rootfind.h"
+#include "Parallel.h"
 
 double Distribution::BlackOpt
 	(double fwd,
@@ -55,3 +56,158 @@ double Distribution::BlackIV
 	THROW("Exhausted iterations in BlackIV");
 }
 
+namespace
+{
+	// normalized Black:  b(x, s) = e^{x/2} N(x/s + s/2) - e^{-x/2} N(x/s - s/2) is the value of a call with F = sqrt(FK) e^{x/2}, K = sqrt(FK) e^{-x/2}
+		// we only ever price out of the money (x <= 0), where b lies below e^{x/2}
+	static const double INV_ROOT_2PI = 1.0 / sqrt(2.0 * DA::PI);
+
+	// Mills ratio R(z) = N(-z) / phi(z) and its derivative R' = z R - 1, by continued fraction where NCDF would underflow or lose relative precision
+	void Mills(double z, double* r, double* dr)
+	{
+		static const int N_TERMS = 60;
+		if (z < 5.0)
+		{
+			*r = NCDF(-z) / (INV_ROOT_2PI * exp(-0.5 * z * z));
+			*dr = z * *r - 1.0;
+			return;
+		}
+		// R = 1 / (z + 1 / w), w = z + 2 / (z + 3 / ...), so that R' = -R / w without cancellation
+		double w = z;
+		for (int k = N_TERMS; k > 1; --k)
+			w = z + k / w;
+		*r = 1.0 / (z + 1.0 / w);
+		*dr = -*r / w;
+	}
+
+	double NormalizedBlack(double x, double s)
+	{
+		static const int MAX_TERMS = 40;
+		const double dPlus = x / s + 0.5 * s, dMinus = dPlus - s;
+		if (s > 1.0)	// no serious cancellation
+			return exp(0.5 * x) * NCDF(dPlus) - exp(-0.5 * x) * NCDF(dMinus);
+		// b = e^{x/2} phi(d+) (R(-d+) - R(-d-)), where for small s the two terms nearly cancel
+			// so we expand the difference in odd powers of h = s/2 about z = -x/s, using R^(n+1) = n R^(n-1) + z R^(n)
+		const double z = -x / s, h = 0.5 * s;
+		double rPrev, r;
+		Mills(z, &rPrev, &r);
+		double sum = 0.0, term = h;	// term is h^k / k!
+		for (int k = 1; k < MAX_TERMS; ++k)
+		{
+			if (k % 2)
+			{
+				sum += term * r;
+				if (fabs(term * r) < 1.0e-17 * fabs(sum))
+					break;
+			}
+			const double rNext = k * rPrev + z * r;
+			rPrev = r;
+			r = rNext;
+			term *= h / (k + 1);
+		}
+		return -2.0 * INV_ROOT_2PI * exp(-0.5 * (z * z + h * h)) * sum;
+	}
+
+	// db/ds = exp(-(x^2/s^2 + s^2/4) / 2) / sqrt(2 pi)
+	double NormalizedVega(double x, double s)
+	{
+		return INV_ROOT_2PI * exp(-0.5 * (Square(x / s) + 0.25 * s * s));
+	}
+
+	// Householder's third-order method, on log(b) below the inflection point of b (preserving relative accuracy for tiny prices) and on b above it
+		// the initial guess is the lower or upper asymptote of b, on either side of the inflection point s = sqrt(2|x|) (Jaeckel, "By Implication")
+	double NormalizedIV(double x, double beta)
+	{
+		static const int MAX_ITERATIONS = 60;
+		static const double TOL = 1.0e-14;
+		assert(x <= 0.0);
+		const double bMax = exp(0.5 * x);
+		REQUIRE(beta < bMax, "Value above maximum in BlackIV");
+		if (beta <= 0.0)
+			return 0.0;
+		const double sC = sqrt(-2.0 * x);
+		const double bC = x < 0.0 ? NormalizedBlack(x, sC) : 0.0;
+		const bool useLog = beta < bC;
+		// below the inflection point, b < s / sqrt(2 pi) also gives a lower bound which is sharp near the money
+		double s = useLog
+				? Max(sqrt(2.0 * x * x / (-x - 4.0 * log(beta / bC))), beta / INV_ROOT_2PI)
+				: -2.0 * InverseNCDF(0.5 * (bMax - beta) / bMax);
+		double sLow = 0.0, sHigh = DA::INFINITY;	// b is increasing in s, so we can maintain a bracket
+		for (int ii = 0; ii < MAX_ITERATIONS; ++ii)
+		{
+			const double b = NormalizedBlack(x, s);
+			if (b == beta)
+				return s;
+			(b < beta ? sLow : sHigh) = s;
+			const double vega = NormalizedVega(x, s);
+			const double h2 = x * x / (s * s * s) - 0.25 * s;	// b''/b'
+			const double h3 = h2 * h2 - 3.0 * x * x / (s * s * s * s) - 0.25;	// b'''/b'
+			double nu, g2, g3;	// Newton step, and the derivative ratios of the function whose root we seek
+			if (useLog)
+			{
+				const double lambda = vega / b;
+				nu = (log(beta) - log(b)) / lambda;
+				g2 = h2 - lambda;
+				g3 = h3 - 3.0 * h2 * lambda + 2.0 * lambda * lambda;
+			}
+			else
+			{
+				nu = (beta - b) / vega;
+				g2 = h2;
+				g3 = h3;
+			}
+			const double next = s + nu * (1.0 + 0.5 * g2 * nu) / (1.0 + nu * (g2 + g3 * nu / 6.0));
+			if (fabs(next - s) <= TOL * s || sHigh - sLow <= TOL * s)	// the latter when rounding error in b stalls the step
+				return next;
+			// if we have left the bracket, bisect it (or expand it, if it is still open)
+			s = next > sLow && next < sHigh
+					? next
+					: (sHigh < DA::INFINITY ? 0.5 * (sLow + sHigh) : 2.0 * s);
+		}
+		THROW("Exhausted iterations in BlackIV");
+	}
+
+	double ImpliedVol(double fwd, double strike, const OptionType_& type, double price)
+	{
+		static const double TOL = 1.0e-12;	// tolerance for prices below intrinsic
+		REQUIRE(IsPositive(fwd) && IsPositive(strike), "BlackIV needs positive forward and strike");
+		// convert to the out-of-the-money option by parity
+		const bool callIsOTM = strike >= fwd;
+		double otm = price;
+		switch (type.Switch())
+		{
+		default:
+			assert(!"Invalid OptionType");
+		case OptionType_::Value_::CALL:
+			otm = callIsOTM ? price : price - (fwd - strike);
+			break;
+		case OptionType_::Value_::PUT:
+			otm = callIsOTM ? price - (strike - fwd) : price;
+			break;
+		case OptionType_::Value_::STRADDLE:
+			otm = 0.5 * (price - fabs(fwd - strike));
+			break;
+		}
+		REQUIRE(otm >= -TOL * Max(fwd, strike), "Value below intrinsic in BlackIV");
+		const double root = sqrt(fwd * strike);
+		return NormalizedIV(-fabs(log(fwd / strike)), otm / root);
+	}
+}	// leave local
+
+Vector_<> Distribution::BlackIV
+	(const Vector_<>& fwds,
+	 const Vector_<>& strikes,
+	 const Vector_<OptionType_>& types,
+	 const Vector_<>& prices)
+{
+	static const int CHUNK = 64;	// quotes per task
+	const int n = prices.size();
+	REQUIRE(fwds.size() == n && strikes.size() == n && types.size() == n, "BlackIV inputs must all have the same size");
+	Vector_<> retval(n);
+	Parallel::For((n + CHUNK - 1) / CHUNK, [&](int ic)
+	{
+		for (int ii = ic * CHUNK; ii < Min(n, (ic + 1) * CHUNK); ++ii)
+			retval[ii] = ImpliedVol(fwds[ii], strikes[ii], types[ii], prices[ii]);
+	});
+	return retval;
+}
@@ -19,6 +19,13 @@ namespace Distribution
 		 const OptionType_& type,
 		 double price,
 		 double guess = 0.0);	// start point of search, useful for deep-otm options
+	// many implied vols at once, spread over threads; needs no guess, and keeps full relative accuracy deep out of the money
+		// the price of an option at (or below) intrinsic gives zero vol
+	Vector_<> BlackIV
+		(const Vector_<>& fwds,
+		 const Vector_<>& strikes,
+		 const Vector_<OptionType_>& types,
+		 const Vector_<>& prices);
 }
 
 class DistributionBlack_ : public Distribution_
@@ -338,3 +338,147 @@ SymmetricMatrixDecomposition_* NewEigenSystem
 
 
 
+
+//----------------------------------------------------------------------------
+// leading eigenmodes only, by thick-restarted Lanczos with full reorthogonalization
+	// the projected matrix is small, so we hand it back to RS rather than exploiting its tridiagonal/arrowhead structure
+namespace
+{
+	void Orthogonalize
+		(const Vector_<Vector_<>>& basis,
+		 int n_basis,
+		 Vector_<>* w,
+		 Vector_<>* coeffs)	// accumulates projections onto each basis vector
+	{
+		for (int pass = 0; pass < 2; ++pass)	// second pass restores orthogonality lost to cancellation
+		{
+			for (int ii = 0; ii < n_basis; ++ii)
+			{
+				const double c = InnerProduct(*w, basis[ii]);
+				(*coeffs)[ii] += c;
+				Transform(w, basis[ii], LinearIncrement(-c));
+			}
+		}
+	}
+
+	// deterministic new direction when the Krylov space becomes invariant
+	bool FreshDirection
+		(const Vector_<Vector_<>>& basis,
+		 int n_basis,
+		 Vector_<>* w)
+	{
+		const int n = w->size();
+		Vector_<> junk(n_basis);
+		for (int ii = 0; ii < n; ++ii)
+		{
+			w->Fill(0.0);
+			(*w)[(ii + n_basis) % n] = 1.0;
+			Orthogonalize(basis, n_basis, w, &junk);
+			const double norm = sqrt(InnerProduct(*w, *w));
+			if (norm > 0.1)
+			{
+				*w *= 1.0 / norm;
+				return true;
+			}
+		}
+		return false;
+	}
+}	// leave local
+
+SymmetricMatrixDecomposition_* NewLeadingEigenSystem
+	(const Matrix_<>& a,
+	 int n_modes,
+	 double tol,
+	 double discard_threshold)
+{
+	static const int MAX_RESTARTS = 200;
+	const int n = a.Rows();
+	REQUIRE(a.Cols() == n, "Eigensystem requires a square matrix");
+	REQUIRE(n_modes > 0 && n_modes <= n, "Number of eigenmodes must be positive and no more than the matrix size");
+	const int m = Min(n, Max(2 * n_modes + 1, n_modes + 20));	// subspace size
+	if (m == n)
+	{	// no savings available, use the full decomposition
+		std::unique_ptr<EigenSystem_> retval(static_cast<EigenSystem_*>(NewEigenSystem(a, discard_threshold)));
+		while (retval->d_.size() > n_modes)
+			retval->d_.pop_back();
+		retval->u_.Resize(Max(1, retval->d_.size()));
+		return retval.release();
+	}
+
+	Vector_<Vector_<>> v(m, Vector_<>(n));
+	Matrix_<> h(m, m);	// projection of a onto the basis v
+	Vector_<> w(n), coeffs(m);
+	for (int ii = 0; ii < n; ++ii)	// correlation matrices are dominated by the parallel mode, so start near it
+		v[0][ii] = 1.0 + 0.5 * sin(ii + 1.0);
+	v[0] *= 1.0 / sqrt(InnerProduct(v[0], v[0]));
+
+	Vector_<> theta;
+	Matrix_<> s;
+	int nKeep = 0;	// leading columns of v which are Ritz vectors from a previous cycle
+	for (int iRestart = 0; ; ++iRestart)
+	{
+		REQUIRE(iRestart < MAX_RESTARTS, "Leading eigensystem failed to converge");
+		double beta = 0.0;	// norm of the residual beyond the last basis vector
+		for (int jj = nKeep; jj < m; ++jj)
+		{
+			for (int ii = 0; ii < n; ++ii)
+				w[ii] = InnerProduct(a.Row(ii), v[jj]);
+			coeffs.Fill(0.0);
+			Orthogonalize(v, jj + 1, &w, &coeffs);
+			for (int ii = 0; ii <= jj; ++ii)
+				h(ii, jj) = h(jj, ii) = coeffs[ii];
+			beta = sqrt(InnerProduct(w, w));
+			if (jj + 1 == m)
+				break;
+			if (beta > DA::EPSILON * (fabs(h(0, 0)) + 1.0))
+			{
+				Transform(w, [&](double w_i) { return w_i / beta; }, &v[jj + 1]);
+				h(jj + 1, jj) = h(jj, jj + 1) = beta;
+			}
+			else
+			{	// invariant subspace:  continue from an unrelated direction
+				REQUIRE(FreshDirection(v, jj + 1, &v[jj + 1]), "Can't extend Krylov basis");
+				h(jj + 1, jj) = h(jj, jj + 1) = 0.0;
+			}
+		}
+		// entries coupling the kept Ritz vectors to each other are exactly zero
+		for (int ii = 0; ii < nKeep; ++ii)
+			for (int jj = 0; jj < ii; ++jj)
+				h(ii, jj) = h(jj, ii) = 0.0;
+
+		Eispack::RS(h, &theta, &s);	// eigenvalues in descending order
+		const double scale = Max(fabs(theta.front()), fabs(theta.back()));
+		bool converged = true;
+		for (int ii = 0; ii < n_modes && converged; ++ii)
+			converged = beta * fabs(s(m - 1, ii)) <= tol * scale;
+
+		// rotate the basis to Ritz vectors
+		nKeep = converged ? n_modes : Min(m - 1, n_modes + (m - n_modes) / 2);
+		Vector_<Vector_<>> ritz(nKeep, Vector_<>(n, 0.0));
+		for (int ii = 0; ii < nKeep; ++ii)
+			for (int jj = 0; jj < m; ++jj)
+				Transform(&ritz[ii], v[jj], LinearIncrement(s(jj, ii)));
+		if (converged)
+		{
+			std::unique_ptr<EigenSystem_> retval(new EigenSystem_);
+			for (int ii = 0; ii < n_modes && theta[ii] > discard_threshold; ++ii)
+			{
+				retval->d_.push_back(theta[ii]);
+				retval->u_.push_back(ritz[ii]);
+			}
+			if (retval->u_.empty())	// don't let u be empty, because Size() uses it
+				retval->u_.push_back(ritz[0]);
+			return retval.release();
+		}
+		// thick restart:  Ritz vectors, then the residual direction
+		for (int ii = 0; ii < nKeep; ++ii)
+		{
+			v[ii].Swap(&ritz[ii]);
+			h(ii, ii) = theta[ii];
+		}
+		if (beta > DA::EPSILON * (scale + 1.0))
+			Transform(w, [&](double w_i) { return w_i / beta; }, &v[nKeep]);
+		else
+			REQUIRE(FreshDirection(v, nKeep, &v[nKeep]), "Can't extend Krylov basis");
+	}
+}
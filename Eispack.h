@@ -22,4 +22,12 @@ namespace Eispack
 SymmetricMatrixDecomposition_* NewEigenSystem
 	(const Matrix_<>& a,
 	 double discard_threshold = 0.0,	// discard eigenmodes with eigenvalues below this
-	 double error_threshold = -DA::INFINITY);	// error on eigenvalues below this
\ No newline at end of file
+	 double error_threshold = -DA::INFINITY);	// error on eigenvalues below this
+
+// only the n_modes algebraically largest eigenmodes, without a full tridiagonalization
+	// worthwhile when n_modes is much smaller than the matrix size
+SymmetricMatrixDecomposition_* NewLeadingEigenSystem
+	(const Matrix_<>& a,
+	 int n_modes,
+	 double tol = 1.0e-10,	// on residual norms, relative to the spectral radius
+	 double discard_threshold = 0.0);	// discard eigenmodes with eigenvalues below this
@@ -116,7 +116,8 @@ namespace Environment
 			}
 			IterImp_* Next() const override
 			{
-				return new MyIter_(all_, ::Next(me_));
+				auto next = ::Next(me_);
+				return next == all_.end() ? nullptr : new MyIter_(all_, next);	// Iterator_ stops at null
 			}
 			const Entry_& operator*() const override
 			{
@@ -127,7 +128,7 @@ namespace Environment
 		Base_(const Vector_<Handle_<Entry_>>& vals = Vector_<Handle_<Entry_>>()) : vals_(vals) {}	// wants constructor sugar
 		MyIter_* XBegin() const override
 		{
-			return new MyIter_(vals_, vals_.begin());
+			return vals_.empty() ? nullptr : new MyIter_(vals_, vals_.begin());
 		}
 	};
 
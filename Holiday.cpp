@@ -2,12 +2,14 @@
 #include "Platform.h"
 #include "Holiday.h"
 #include <mutex>
+#include <atomic>
+#include <vector>
 #include "Strict.h"
 
 #include "HolidayData.h"
 #include "Algorithms.h"
 
-static std::mutex TheHolidayComboMutex;
+static std::mutex TheHolidayComboMutex;	// serializes additions to the registry; lookups do not lock
 #define LOCK_COMBOS std::lock_guard<std::mutex> l(TheHolidayComboMutex)
 
 namespace
@@ -19,10 +21,49 @@ namespace
 		static const auto ToName = [](const Handle_<HolidayCenterData_> h) {return h->center_; };
 		return String::Accumulate(Apply(ToName, parts), " ");
 	}
-	// index this map ONLY using canonical center-set strings
-	std::map<String_, Handle_<HolidayCenterData_>>& TheCombinations()
+
+	// merged calendars, indexed ONLY by canonical center-set strings
+		// each snapshot is immutable; an addition publishes a new one, and old ones are kept because readers may still hold them
+	typedef std::map<String_, Handle_<HolidayCenterData_>> combos_t;
+	std::vector<std::unique_ptr<const combos_t>>& AllSnapshots()
+	{
+		RETURN_STATIC(std::vector<std::unique_ptr<const combos_t>>);
+	}
+	std::atomic<const combos_t*>& TheCombinations()
+	{
+		static const combos_t EMPTY;
+		static std::atomic<const combos_t*> RETVAL(&EMPTY);
+		return RETVAL;
+	}
+
+	Handle_<HolidayCenterData_> FindMerged(const String_& name)
+	{
+		const combos_t& combos = *TheCombinations().load();
+		auto p = combos.find(name);
+		return p == combos.end() ? Handle_<HolidayCenterData_>() : p->second;
+	}
+
+	Handle_<HolidayCenterData_> Merged(const Vector_<Handle_<HolidayCenterData_>>& parts)
 	{
-      RETURN_STATIC(std::map<String_, Handle_<HolidayCenterData_>>);
+		const String_ name = NameFromCenters(parts);
+		auto retval = FindMerged(name);
+		if (retval.Empty())
+		{
+			LOCK_COMBOS;
+			retval = FindMerged(name);	// another thread may have added it while we waited
+			if (retval.Empty())
+			{
+				Vector_<Date_> merged;
+				for (const auto& p : parts)
+					merged.Append(p->holidays_);
+				retval.reset(new HolidayCenterData_(name, Unique(merged)));
+				std::unique_ptr<combos_t> next(new combos_t(*TheCombinations().load()));
+				(*next)[name] = retval;
+				TheCombinations().store(next.get());
+				AllSnapshots().emplace_back(std::move(next));
+			}
+		}
+		return retval;
 	}
 }
 
@@ -32,21 +73,18 @@ Holidays_::Holidays_(const String_& src)
 	Vector_<String_> centers = String::Split(src, ' ', false);
 	parts_ = Unique(Apply([](const String_& c){return Holidays::OfCenter(Holidays::CenterIndex(c)); }, centers));
 	if (parts_.size() > 1)
-	{
-		// check for an existing combined data, but do not create one
-		LOCK_COMBOS;
-		auto existing = TheCombinations().find(NameFromCenters(parts_));
-		if (existing != TheCombinations().end())
-			parts_ = Vector::V1(existing->second);
-	}
+		parts_ = Vector::V1(Merged(parts_));	// lookup is lock-free once the combination has been seen
 }
 
 bool Holidays_::IsHoliday(const Date_& date) const
 {
-	for (const auto& ps : parts_)
-		if (BinarySearch(ps->holidays_, date))
-			return true;
-	return false;
+	return Compiled().IsHoliday(date);
+}
+
+const BusinessDays_& Holidays_::Compiled() const
+{
+	static const BusinessDays_ WEEKENDS_ONLY((Vector_<Date_>()));
+	return parts_.empty() ? WEEKENDS_ONLY : parts_[0]->Compiled();
 }
 
 String_ Holidays_::String() const
@@ -55,61 +93,24 @@ String_ Holidays_::String() const
 }
 
 CountBusDays_::CountBusDays_(const Holidays_& src) : hols_(src)
-{
-	if (src.parts_.size() > 1)	// the holiday calendar is not merged
-	{
-		LOCK_COMBOS;
-		Handle_<HolidayCenterData_>& combo = TheCombinations()[src.String()];
-		if (combo.Empty())
-		{
-			Vector_<Date_> merged;
-			for (const auto& p : src.parts_)
-				merged.Append(p->holidays_);
-			combo.reset(new HolidayCenterData_(src.String(), Unique(merged)));
-		}
-		// change our internal instance (Holidays_ constructed after this will also be merged)
-		hols_.parts_ = Vector::V1(combo);
-	}
-}
+{	}
 
 int CountBusDays_::operator()(const Date_& start, const Date_& end) const
 {
-	if (end <= start)
-		return 0;
-	const int weeks = (end - start) / 7;
-	const Date_& stop = start.AddDays(7 * weeks);
-	auto pStop = LowerBound(hols_.parts_[0]->holidays_, stop);
-	const Vector_<Date_>& hols = hols_.parts_[0]->holidays_;
-	const auto holsToStop = static_cast<int>(pStop - LowerBound(hols, start));	// # which are >= start and < stop
-	int retval = 5 * weeks - holsToStop;
-	// now add the fraction-of-week
-	for (Date_ d = stop; d < end; ++d)
-		if (!Date::IsWeekend(d))
-		{
-			if (*pStop == d)
-				++pStop;
-			else
-				++retval;
-		}
-
-	return retval;
+	return hols_.Compiled().Count(start, end);
 }
 
 Date_ Holidays::NextBus(const Holidays_& hols, const Date_& from)
 {
-	for (Date_ retval = from;; ++retval)
-	{
-		if (!Date::IsWeekend(retval) && !hols.IsHoliday(retval))
-			return retval;
-	}
+	return hols.Compiled().NextBus(from);
 }
 Date_ Holidays::PrevBus(const Holidays_& hols, const Date_& from)
 {
-	for (Date_ retval = from;; --retval)
-	{
-      if (!Date::IsWeekend(retval) && !hols.IsHoliday(retval))
-			return retval;
-	}
+	return hols.Compiled().PrevBus(from);
+}
+Date_ Holidays::AddBus(const Holidays_& hols, const Date_& from, int n_days)
+{
+	return hols.Compiled().AddBus(from, n_days);
 }
 
 const Holidays_& Holidays::None()
@@ -9,12 +9,12 @@ class Date_;
 
 class Holidays_     
 {
-	Vector_<Handle_<HolidayCenterData_>> parts_;	// calendars for each center
-	friend class CountBusDays_;
+	Vector_<Handle_<HolidayCenterData_>> parts_;	// at most one calendar; multiple centers are merged on construction
 public:
 	Holidays_(const String_& src);
 	String_ String() const;
 	bool IsHoliday(const Date_& date) const;
+	const BusinessDays_& Compiled() const;
 };
 
 namespace Holidays
@@ -22,6 +22,8 @@ namespace Holidays
 	const Holidays_& None();
 	Date_ NextBus(const Holidays_& hols, const Date_& from);	// returns input date if it is already a good business day
 	Date_ PrevBus(const Holidays_& hols, const Date_& from);
+	// the n'th business day after from (before it, if n is negative); NextBus if n is zero
+	Date_ AddBus(const Holidays_& hols, const Date_& from, int n_days);
 }
 
 // this is internally optimized with precomputed merged schedules
@@ -31,6 +33,7 @@ class CountBusDays_
 	Holidays_ hols_;
 public:
 	CountBusDays_(const Holidays_& holidays);
+	// weekdays in [begin, end) which are not holidays; a listed holiday falling on a weekend is not subtracted again
 	int operator()(const Date_& begin, const Date_& end) const;
 };
 
@@ -7,6 +7,63 @@
 #include "Exceptions.h"
 #include "Algorithms.h"
 
+BusinessDays_::BusinessDays_(const Vector_<Date_>& holidays)
+	:
+holiday_((1 << 16) / 64, 0),
+before_((1 << 16) + 1)
+{
+	for (const auto& h : holidays)
+	{
+		const int s = Serial(h);
+		holiday_[s >> 6] |= uint64_t(1) << (s & 63);
+	}
+	before_[0] = 0;
+	Date_ dt;
+	for (int s = 0; s < (1 << 16); ++s, ++dt)
+	{
+		const bool isBus = dt.IsValid() && !Date::IsWeekend(dt) && !IsHoliday(dt);
+		if (isBus)
+			bus_.push_back(dt);
+		before_[s + 1] = before_[s] + (isBus ? 1 : 0);
+	}
+}
+
+Date_ BusinessDays_::NextBus(const Date_& from) const
+{
+	const int i = before_[Serial(from)];
+	REQUIRE(i < bus_.size(), "No business day after " + Date::ToString(from));
+	return bus_[i];
+}
+
+Date_ BusinessDays_::PrevBus(const Date_& from) const
+{
+	const int i = before_[Serial(from) + 1] - 1;
+	REQUIRE(i >= 0, "No business day before " + Date::ToString(from));
+	return bus_[i];
+}
+
+Date_ BusinessDays_::AddBus(const Date_& from, int n_days) const
+{
+	if (n_days == 0)
+		return NextBus(from);
+	const int i = n_days > 0 ? before_[Serial(from) + 1] - 1 + n_days : before_[Serial(from)] + n_days;
+	REQUIRE(i >= 0 && i < bus_.size(), "Business day offset out of range from " + Date::ToString(from));
+	return bus_[i];
+}
+
+const BusinessDays_& HolidayCenterData_::Compiled() const
+{
+	const BusinessDays_* retval = compiled_.load();
+	if (!retval)
+	{
+		// another thread may race us here; the first to finish wins
+		std::unique_ptr<const BusinessDays_> mine(new BusinessDays_(holidays_));
+		if (compiled_.compare_exchange_strong(retval, mine.get()))
+			retval = mine.release();
+	}
+	return *retval;
+}
+
 static std::mutex TheHolidayDataMutex;
 #define LOCK_DATA std::lock_guard<std::mutex> l(TheHolidayDataMutex)
 
@@ -4,15 +4,40 @@
 #pragma once
 
 #include <map>
+#include <atomic>
 #include "Vectors.h"
 #include "Strings.h"
 #include "Date.h"
 
+// a calendar compiled over the whole range of Date_, so that queries need no search
+struct BusinessDays_
+{
+	Vector_<uint64_t> holiday_;	// one bit per date serial
+	Vector_<uint16_t> before_;	// number of business days before each date serial, plus a final total
+	Vector_<Date_> bus_;	// all business days in order; bus_[before_[s]] is the first on-or-after serial s
+	explicit BusinessDays_(const Vector_<Date_>& holidays);
+
+	static int Serial(const Date_& dt) { return dt - Date_(); }
+	bool IsHoliday(const Date_& dt) const
+	{
+		const int s = Serial(dt);
+		return ((holiday_[s >> 6] >> (s & 63)) & 1) != 0;
+	}
+	Date_ NextBus(const Date_& from) const;
+	Date_ PrevBus(const Date_& from) const;
+	Date_ AddBus(const Date_& from, int n_days) const;
+	int Count(const Date_& begin, const Date_& end) const { return end <= begin ? 0 : before_[Serial(end)] - before_[Serial(begin)]; }
+};
+
 struct HolidayCenterData_
 {
 	String_ center_;
 	Vector_<Date_> holidays_;
-	HolidayCenterData_(const String_& c, const Vector_<Date_>& h) : center_(c), holidays_(h) {}
+	HolidayCenterData_(const String_& c, const Vector_<Date_>& h) : center_(c), holidays_(h), compiled_(nullptr) {}
+	~HolidayCenterData_() { delete compiled_.load(); }
+	const BusinessDays_& Compiled() const;	// built on first use
+private:
+	mutable std::atomic<const BusinessDays_*> compiled_;	// owned; never replaced once set
 };
 
 struct HolidayData_
@@ -3,11 +3,68 @@
 #include "Interp.h"
 #include "Strict.h"
 
+#include "Algorithms.h"
 #include "Functionals.h"
 #include "Exceptions.h"
 
 Interp1_::Interp1_(const String_& name) : Storable_("Interp1", name) {}
 
+void Interp1_::Evaluate(const Vector_<>& x, Vector_<>* f) const
+{
+	f->Resize(x.size());
+	Transform(x, [&](double x_i) { return (*this)(x_i); }, f);
+}
+
+Interp2_::Interp2_(const String_& name) : Storable_("Interp2", name) {}
+
+void Interp2_::Evaluate(double x1, const Vector_<>& x2, Vector_<>* f) const
+{
+	f->Resize(x2.size());
+	Transform(x2, [&](double x2_i) { return (*this)(x1, x2_i); }, f);
+}
+
+void Interp1::Locate(const Vector_<>& knots, const Vector_<>& x, Vector_<int>* n_le)
+{
+	static const int MAX_GALLOP = 8;	// further than this, the previous answer is no help
+	const int n = knots.size();
+	n_le->Resize(x.size());
+	int prev = 0;
+	bool hinted = true;	// whether the last answer was near the one before
+	for (int ii = 0; ii < x.size(); ++ii)
+	{
+		const double xi = x[ii];
+		// gallop from prev to bracket the answer in [lo, hi], then bisect
+		int lo = 0, hi = n;
+		if (!hinted)
+		{	}
+		else if (prev < n && knots[prev] <= xi)
+		{
+			lo = hi = prev + 1;
+			for (int step = 1; hi < n && knots[hi] <= xi; step *= 2)
+			{
+				lo = hi + 1;
+				hi = step < MAX_GALLOP ? hi + step : n;
+			}
+			hi = Min(hi, n);
+		}
+		else if (prev > 0 && knots[prev - 1] > xi)
+		{
+			lo = hi = prev - 1;
+			for (int step = 1; lo > 0 && knots[lo - 1] > xi; step *= 2)
+			{
+				hi = lo - 1;
+				lo = step < MAX_GALLOP ? lo - step : 0;
+			}
+			lo = Max(lo, 0);
+		}
+		else
+			lo = hi = prev;
+		const int next = static_cast<int>(std::upper_bound(knots.begin() + lo, knots.begin() + hi, xi) - knots.begin());
+		hinted = abs(next - prev) <= MAX_GALLOP;
+		(*n_le)[ii] = prev = next;
+	}
+}
+
 Interp1Linear_::Interp1Linear_(const String_& name, const Vector_<>& x, const Vector_<>& f) : Interp1_(name), x_(x), f_(f)
 {
 	assert(x.size() == f.size());
@@ -50,6 +107,23 @@ double Interp1Linear_::operator()(double x) const
 	}
 }
 
+void Interp1Linear_::Evaluate(const Vector_<>& x, Vector_<>* f) const
+{
+	Vector_<int> nLE;
+	Interp1::Locate(x_, x, &nLE);
+	// slopes padded with zero at both ends, so extrapolation is flat without a branch
+	const int n = x_.size();
+	Vector_<> slope(n + 1, 0.0);
+	for (int ii = 1; ii < n; ++ii)
+		slope[ii] = (f_[ii] - f_[ii - 1]) / (x_[ii] - x_[ii - 1]);
+	f->Resize(x.size());
+	for (int ii = 0; ii < x.size(); ++ii)
+	{
+		const int iLE = Max(nLE[ii] - 1, 0);
+		(*f)[ii] = f_[iLE] + (x[ii] - x_[iLE]) * slope[nLE[ii]];
+	}
+}
+
 namespace
 {
 #include "MG_Interp1Linear_v1_Write.inc"
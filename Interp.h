@@ -10,6 +10,8 @@ public:
 	Interp1_(const String_& name);
 	virtual double operator()(double x) const = 0;
 	virtual bool IsInBounds(double x) const { return true; }
+	// values at many points; cheapest when x is sorted, but any order is allowed
+	virtual void Evaluate(const Vector_<>& x, Vector_<>* f) const;
 };
 
 /*IF--------------------------------------------------------------------------
@@ -30,6 +32,7 @@ public:
 	Interp1Linear_(const String_& name, const std::map<double, double>& f);
 	void Write(Archive::Store_& dst) const override;
 	double operator()(double x) const override;
+	void Evaluate(const Vector_<>& x, Vector_<>* f) const override;
 };
 
 class Interp2_ : public Storable_
@@ -38,10 +41,16 @@ public:
 	Interp2_(const String_& name);
 	virtual double operator()(double x1, double x2) const = 0;
 	virtual bool IsInBounds(double x1, double x2) const = 0;
+	// values at many x2 for a single x1
+	virtual void Evaluate(double x1, const Vector_<>& x2, Vector_<>* f) const;
 };
 
 namespace Interp1
 {
+	// for each x, the number of knots <= x (as from UpperBound)
+		// each search starts from the previous answer, so sorted x are merge-walked in O(knots + x)
+	void Locate(const Vector_<>& knots, const Vector_<>& x, Vector_<int>* n_le);
+
 	template<class T_> struct Of_
 	{
 		Handle_<Interp1_> imp_;
@@ -25,7 +25,9 @@ fpp is number[]
 	struct Cubic1_ : Interp1_
 	{
 		Vector_<> x_, f_, fpp_;
+		Vector_<> c1_, c2_, c3_;	// polynomial in (x - x_[i]) on each interval, with constant term f_[i]; extended at the ends
 		double operator()(double x) const override;
+		void Evaluate(const Vector_<>& x, Vector_<>* f) const override;
 		bool IsInBounds(double x) const override { return x >= x_.front() && x <= x_.back(); }	// simply forbid extrapolation
 
 		Cubic1_
@@ -55,6 +57,20 @@ fpp is number[]
 		return a * f_[iLT] + b * f_[iGE] - a * b * ((1.0 + a) * fpp_[iLT] + (1.0 + b) * fpp_[iGE]) * Square(h) / 6.0;
 	}
 
+	void Cubic1_::Evaluate(const Vector_<>& x, Vector_<>* f) const
+	{
+		Vector_<int> nLE;
+		Interp1::Locate(x_, x, &nLE);
+		f->Resize(x.size());
+		const int nMax = x_.size() - 2;
+		for (int ii = 0; ii < x.size(); ++ii)
+		{
+			const int i = Min(Max(nLE[ii] - 1, 0), nMax);
+			const double t = x[ii] - x_[i];
+			(*f)[ii] = f_[i] + t * (c1_[i] + t * (c2_[i] + t * c3_[i]));
+		}
+	}
+
 	// the spline-fitting process
 	Cubic1_::Cubic1_
 		(const String_& name, 
@@ -122,6 +138,17 @@ fpp is number[]
 		}
 		for (int k = n - 2; k >= 0; --k)  // backsubstitution
 			fpp_[k] += u[k] * fpp_[k + 1];
+
+		c1_.Resize(n - 1);
+		c2_.Resize(n - 1);
+		c3_.Resize(n - 1);
+		for (int i = 0; i < n - 1; ++i)
+		{
+			const double h = x_[i + 1] - x_[i];
+			c1_[i] = (f_[i + 1] - f_[i]) / h - h * (2.0 * fpp_[i] + fpp_[i + 1]) / 6.0;
+			c2_[i] = 0.5 * fpp_[i];
+			c3_[i] = (fpp_[i + 1] - fpp_[i]) / (6.0 * h);
+		}
 	}
 }  // leave local
 
@@ -0,0 +1,292 @@
+
+#include "Platform.h"
+#include "InterpGrid.h"
+#include "Strict.h"
+
+#include "Algorithms.h"
+#include "Functionals.h"
+#include "Exceptions.h"
+
+void Interp::Grid2_::Evaluate(double x1, const Vector_<>& x2, Vector_<>* f) const
+{
+	std::unique_ptr<Interp1_> section(NewSection(x1));
+	section->Evaluate(x2, f);
+}
+
+namespace
+{
+/*IF--------------------------------------------------------------------------
+storable Interp2Bilinear
+	Bilinear interpolator on a tensor grid
+version 1
+&members
+name is ?string
+x1 is number[]
+	Knots in the first dimension, increasing
+x2 is number[]
+	Knots in the second dimension, increasing
+f is number[][]
+	Values, with f[i][j] at (x1[i], x2[j])
+&conditions
+f.Rows() == x1.size() && f.Cols() == x2.size()
+	Grid values must match knots
+-IF-------------------------------------------------------------------------*/
+
+/*IF--------------------------------------------------------------------------
+storable Interp2Bicubic
+	Bicubic interpolator on a tensor grid
+version 1
+&members
+name is ?string
+x1 is number[]
+	Knots in the first dimension, increasing
+x2 is number[]
+	Knots in the second dimension, increasing
+f is number[][]
+	Values, with f[i][j] at (x1[i], x2[j])
+&conditions
+f.Rows() == x1.size() && f.Cols() == x2.size()
+	Grid values must match knots
+-IF-------------------------------------------------------------------------*/
+
+#include "MG_Interp2Bilinear_v1_Write.inc"
+#include "MG_Interp2Bicubic_v1_Write.inc"
+
+	void CheckGrid(const Vector_<>& x1, const Vector_<>& x2, const Matrix_<>& f)
+	{
+		REQUIRE(x1.size() > 1 && x2.size() > 1, "Need at least two knots in each dimension");
+		REQUIRE(IsMonotonic(x1) && IsMonotonic(x2), "Grid knots must be increasing");
+		REQUIRE(f.Rows() == x1.size() && f.Cols() == x2.size(), "Grid values must match knots");
+	}
+
+	// index of the cell containing x, with the fractional position in it; both are clamped to the grid
+	int Cell(const Vector_<>& knots, double x, double* frac)
+	{
+		const int i = Min(Max(static_cast<int>(UpperBound(knots, x) - knots.begin()) - 1, 0), knots.size() - 2);
+		*frac = Min(Max((x - knots[i]) / (knots[i + 1] - knots[i]), 0.0), 1.0);
+		return i;
+	}
+
+	bool InGrid(const Vector_<>& x1, const Vector_<>& x2, double y1, double y2)
+	{
+		return y1 >= x1.front() && y1 <= x1.back() && y2 >= x2.front() && y2 <= x2.back();
+	}
+
+	class Bilinear_ : public Interp::Grid2_
+	{
+		Vector_<> x1_, x2_;
+		Matrix_<> f_;
+	public:
+		Bilinear_(const String_& name, const Vector_<>& x1, const Vector_<>& x2, const Matrix_<>& f)
+			: Grid2_(name), x1_(x1), x2_(x2), f_(f)
+		{
+			CheckGrid(x1_, x2_, f_);
+		}
+
+		double operator()(double x1, double x2) const override
+		{
+			double u, v;
+			const int i = Cell(x1_, x1, &u);
+			const int j = Cell(x2_, x2, &v);
+			const auto lo = f_.Row(i), hi = f_.Row(i + 1);
+			return (1.0 - u) * ((1.0 - v) * lo[j] + v * lo[j + 1]) + u * ((1.0 - v) * hi[j] + v * hi[j + 1]);
+		}
+		bool IsInBounds(double x1, double x2) const override { return InGrid(x1_, x2_, x1, x2); }
+
+		Interp1_* NewSection(double x1) const override
+		{
+			double u;
+			const int i = Cell(x1_, x1, &u);
+			Vector_<> f(x2_.size());
+			Transform(f_.Row(i), f_.Row(i + 1), [u](double lo, double hi) { return lo + u * (hi - lo); }, &f);
+			return new Interp1Linear_(name_, x2_, f);
+		}
+
+		void Write(Archive::Store_& dst) const override
+		{
+			Interp2Bilinear_v1::XWrite(dst, name_, x1_, x2_, f_);
+		}
+	};
+
+	// derivatives at the knots, from the parabola through each knot and its neighbours (or the nearest three knots, at the ends)
+	template<class F_> Vector_<> Slopes(const Vector_<>& x, const F_& f)
+	{
+		const int n = x.size();
+		if (n == 2)
+			return Vector_<>(2, (f(1) - f(0)) / (x[1] - x[0]));
+		Vector_<> retval(n);
+		for (int i = 0; i < n; ++i)
+		{
+			const int m = Min(Max(i, 1), n - 2);	// middle of the three knots used
+			const double hm = x[m] - x[m - 1], hp = x[m + 1] - x[m];
+			const double dm = (f(m) - f(m - 1)) / hm, dp = (f(m + 1) - f(m)) / hp;
+			const double curve = 2.0 * (dp - dm) / (hm + hp);	// second derivative of the parabola
+			retval[i] = (hp * dm + hm * dp) / (hm + hp) + curve * (x[i] - x[m]);
+		}
+		return retval;
+	}
+
+	// a cubic in the fractional position within each cell of x2_; a section through a bicubic grid
+	class BicubicSection_ : public Interp1_
+	{
+		Vector_<> x2_;
+		Vector_<> c_;	// four coefficients per cell, contiguous
+		double At(int j, double v) const
+		{
+			const double* c = &c_[4 * j];
+			return c[0] + v * (c[1] + v * (c[2] + v * c[3]));
+		}
+	public:
+		BicubicSection_(const String_& name, const Vector_<>& x2, const Vector_<>& c) : Interp1_(name), x2_(x2), c_(c) {}
+
+		double operator()(double x) const override
+		{
+			double v;
+			const int j = Cell(x2_, x, &v);
+			return At(j, v);
+		}
+		void Evaluate(const Vector_<>& x, Vector_<>* f) const override
+		{
+			Vector_<int> nLE;
+			Interp1::Locate(x2_, x, &nLE);
+			f->Resize(x.size());
+			const int jMax = x2_.size() - 2;
+			for (int ii = 0; ii < x.size(); ++ii)
+			{
+				const int j = Min(Max(nLE[ii] - 1, 0), jMax);
+				const double v = Min(Max((x[ii] - x2_[j]) / (x2_[j + 1] - x2_[j]), 0.0), 1.0);
+				(*f)[ii] = At(j, v);
+			}
+		}
+		void Write(Archive::Store_&) const override
+		{
+			THROW("Sections of bicubic interpolators are not storable");
+		}
+	};
+
+	class Bicubic_ : public Interp::Grid2_
+	{
+		Vector_<> x1_, x2_;
+		Matrix_<> f_;
+		Vector_<> a_;	// 16 coefficients per cell, contiguous, with cells in row-major order; a[4k + l] multiplies u^k v^l
+
+		const double* Coeffs(int i, int j) const { return &a_[16 * (i * (x2_.size() - 1) + j)]; }
+	public:
+		Bicubic_(const String_& name, const Vector_<>& x1, const Vector_<>& x2, const Matrix_<>& f)
+			: Grid2_(name), x1_(x1), x2_(x2), f_(f)
+		{
+			CheckGrid(x1_, x2_, f_);
+			const int n1 = x1_.size(), n2 = x2_.size();
+			Matrix_<> f1(n1, n2), f2(n1, n2), f12(n1, n2);	// derivatives in x1, x2, and both
+			for (int i = 0; i < n1; ++i)
+			{
+				auto row = f2.Row(i);
+				Copy(Slopes(x2_, [&](int j) { return f_(i, j); }), &row);
+			}
+			for (int j = 0; j < n2; ++j)
+			{
+				const Vector_<> s1 = Slopes(x1_, [&](int i) { return f_(i, j); });
+				const Vector_<> s12 = Slopes(x1_, [&](int i) { return f2(i, j); });
+				for (int i = 0; i < n1; ++i)
+				{
+					f1(i, j) = s1[i];
+					f12(i, j) = s12[i];
+				}
+			}
+
+			// A = M F M^T, where F holds values and scaled derivatives at the corners and M maps Hermite data to monomial coefficients
+			static const double M[4][4] = { { 1.0, 0.0, 0.0, 0.0 }, { 0.0, 0.0, 1.0, 0.0 }, { -3.0, 3.0, -2.0, -1.0 }, { 2.0, -2.0, 1.0, 1.0 } };
+			a_.Resize(16 * (n1 - 1) * (n2 - 1));
+			for (int i = 0; i < n1 - 1; ++i)
+			{
+				const double h1 = x1_[i + 1] - x1_[i];
+				for (int j = 0; j < n2 - 1; ++j)
+				{
+					const double h2 = x2_[j + 1] - x2_[j];
+					double F[4][4], MF[4][4];
+					for (int di = 0; di < 2; ++di)
+					{
+						for (int dj = 0; dj < 2; ++dj)
+						{
+							F[di][dj] = f_(i + di, j + dj);
+							F[di][2 + dj] = h2 * f2(i + di, j + dj);
+							F[2 + di][dj] = h1 * f1(i + di, j + dj);
+							F[2 + di][2 + dj] = h1 * h2 * f12(i + di, j + dj);
+						}
+					}
+					for (int k = 0; k < 4; ++k)
+						for (int m = 0; m < 4; ++m)
+							MF[k][m] = M[k][0] * F[0][m] + M[k][1] * F[1][m] + M[k][2] * F[2][m] + M[k][3] * F[3][m];
+					double* a = &a_[16 * (i * (n2 - 1) + j)];
+					for (int k = 0; k < 4; ++k)
+						for (int l = 0; l < 4; ++l)
+							a[4 * k + l] = MF[k][0] * M[l][0] + MF[k][1] * M[l][1] + MF[k][2] * M[l][2] + MF[k][3] * M[l][3];
+				}
+			}
+		}
+
+		double operator()(double x1, double x2) const override
+		{
+			double u, v;
+			const int i = Cell(x1_, x1, &u);
+			const int j = Cell(x2_, x2, &v);
+			const double* a = Coeffs(i, j);
+			double retval = 0.0;
+			for (int k = 3; k >= 0; --k)
+				retval = retval * u + (a[4 * k] + v * (a[4 * k + 1] + v * (a[4 * k + 2] + v * a[4 * k + 3])));
+			return retval;
+		}
+		bool IsInBounds(double x1, double x2) const override { return InGrid(x1_, x2_, x1, x2); }
+
+		// collapses each cell's coefficients in u, leaving a cubic in v
+		Interp1_* NewSection(double x1) const override
+		{
+			double u;
+			const int i = Cell(x1_, x1, &u);
+			const int nc = x2_.size() - 1;
+			Vector_<> c(4 * nc);
+			for (int j = 0; j < nc; ++j)
+			{
+				const double* a = Coeffs(i, j);
+				for (int l = 0; l < 4; ++l)
+					c[4 * j + l] = a[l] + u * (a[4 + l] + u * (a[8 + l] + u * a[12 + l]));
+			}
+			return new BicubicSection_(name_, x2_, c);
+		}
+
+		void Write(Archive::Store_& dst) const override
+		{
+			Interp2Bicubic_v1::XWrite(dst, name_, x1_, x2_, f_);
+		}
+	};
+
+#include "MG_Interp2Bilinear_v1_Read.inc"
+#include "MG_Interp2Bicubic_v1_Read.inc"
+
+	Storable_* Interp2Bilinear_v1::Reader_::Build() const
+	{
+		return new Bilinear_(name_, x1_, x2_, f_);
+	}
+	Storable_* Interp2Bicubic_v1::Reader_::Build() const
+	{
+		return new Bicubic_(name_, x1_, x2_, f_);
+	}
+}	// leave local
+
+Interp::Grid2_* Interp::NewBilinear
+	(const String_& name,
+	 const Vector_<>& x1,
+	 const Vector_<>& x2,
+	 const Matrix_<>& f)
+{
+	return new Bilinear_(name, x1, x2, f);
+}
+
+Interp::Grid2_* Interp::NewBicubic
+	(const String_& name,
+	 const Vector_<>& x1,
+	 const Vector_<>& x2,
+	 const Matrix_<>& f)
+{
+	return new Bicubic_(name, x1, x2, f);
+}
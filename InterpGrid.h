@@ -0,0 +1,32 @@
+// interpolation on a tensor grid in two dimensions
+
+#pragma once
+
+#include "Interp.h"
+class String_;
+
+namespace Interp
+{
+	// interpolates f(i, j), the value at (x1[i], x2[j]); flat outside the grid
+	class Grid2_ : public Interp2_
+	{
+	public:
+		Grid2_(const String_& name) : Interp2_(name) {}
+		// the interpolant at fixed x1, for repeated queries at one time slice
+		virtual Interp1_* NewSection(double x1) const = 0;
+		void Evaluate(double x1, const Vector_<>& x2, Vector_<>* f) const override;
+	};
+
+	Grid2_* NewBilinear
+		(const String_& name,
+		 const Vector_<>& x1,
+		 const Vector_<>& x2,
+		 const Matrix_<>& f);
+
+	// C1 bicubic Hermite patches, with node derivatives from the parabola through each node and its neighbours
+	Grid2_* NewBicubic
+		(const String_& name,
+		 const Vector_<>& x1,
+		 const Vector_<>& x2,
+		 const Matrix_<>& f);
+}
@@ -0,0 +1,44 @@
+
+#include "Platform.h"
+#include "LVGrid.h"
+#include "Strict.h"
+
+#include "Algorithms.h"
+#include "Exceptions.h"
+#include "LVSurface.h"
+#include "Step.h"
+
+LV::Grid_::Grid_
+	(const LVSurface_& surface,
+	 const Vector_<DateTime_>& times,
+	 double num_sigma,
+	 int n_spot)
+	:
+times_(times),
+logLo_(times.size()),
+invDx_(times.size()),
+nSpot_(n_spot),
+vols_(times.size() * n_spot)
+{
+	NOTE("Sampling local vol onto grid");
+	REQUIRE(n_spot > 1, "Local vol grid needs at least two spot points");
+	REQUIRE(IsMonotonic(times_), "Local vol grid times must be increasing");
+	std::unique_ptr<StepAccumulator_> accumulator(surface.NewAccumulator());
+	for (int it = 0; it < times_.size(); ++it)
+	{
+		const pair<double, double> envelope = surface.UpdateEnvelope(accumulator.get(), times_[it], num_sigma);
+		REQUIRE(envelope.first > 0.0 && envelope.second >= envelope.first, "Local vol envelope must be positive");
+		logLo_[it] = log(envelope.first);
+		const double dx = Max(log(envelope.second) - logLo_[it], DA::EPSILON) / (nSpot_ - 1);
+		invDx_[it] = 1.0 / dx;
+		double* v = &vols_[it * nSpot_];
+		for (int is = 0; is < nSpot_; ++is)
+			v[is] = surface.LocalVol(times_[it], exp(logLo_[it] + is * dx));
+	}
+}
+
+void LV::Grid_::LocalVol(int i_time, const Vector_<>& s, Vector_<>* vols) const
+{
+	vols->Resize(s.size());
+	Transform(s, [&](double s_i) { return LocalVolLog(i_time, log(s_i)); }, vols);
+}
@@ -0,0 +1,40 @@
+// local vol sampled onto fixed times and a uniform log-spot grid, for steppers which query the same slices repeatedly
+
+#pragma once
+
+#include "Vectors.h"
+#include "DateTime.h"
+
+class LVSurface_;
+
+namespace LV
+{
+	// the surface's own wing extrapolation is sampled along with the rest, so lookups never call it
+	class Grid_ : noncopyable
+	{
+		Vector_<DateTime_> times_;
+		Vector_<> logLo_, invDx_;	// grid start and inverse spacing, by time
+		int nSpot_;
+		Vector_<> vols_;	// nSpot_ values per time, contiguous
+	public:
+		Grid_
+			(const LVSurface_& surface,
+			 const Vector_<DateTime_>& times,	// increasing
+			 double num_sigma = 5.0,	// each slice covers the surface's envelope at this width
+			 int n_spot = 201);
+
+		int Size() const { return times_.size(); }
+		const DateTime_& Time(int i_time) const { return times_[i_time]; }
+
+		// local vol at times[i_time]; linear in log-spot between grid points, flat outside the envelope
+		double LocalVolLog(int i_time, double log_s) const
+		{
+			const double y = Min(Max((log_s - logLo_[i_time]) * invDx_[i_time], 0.0), nSpot_ - 1.0);
+			const int j = Min(static_cast<int>(y), nSpot_ - 2);
+			const double* v = &vols_[i_time * nSpot_ + j];
+			return v[0] + (y - j) * (v[1] - v[0]);
+		}
+		double LocalVol(int i_time, double s) const { return LocalVolLog(i_time, log(s)); }
+		void LocalVol(int i_time, const Vector_<>& s, Vector_<>* vols) const;
+	};
+}
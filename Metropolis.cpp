@@ -0,0 +1,74 @@
+
+#include "Platform.h"
+#include "Metropolis.h"
+#include "Strict.h"
+
+#include "Algorithms.h"
+#include "Exceptions.h"
+#include "Parallel.h"
+
+Metropolis::Problem_::~Problem_()
+{	}
+
+pair<Vector_<>, double> Metropolis::Temper
+	(const Problem_& problem,
+	 const Vector_<>& x_init,
+	 const Vector_<>& temperatures,
+	 int n_rounds,
+	 int steps_per_round,
+	 const Random_& rand_src,
+	 double half_life)
+{
+	const int nChains = temperatures.size();
+	REQUIRE(nChains > 0, "Parallel tempering needs at least one temperature");
+	REQUIRE(AllOf(temperatures, IsPositive), "Tempering temperatures must be positive");
+	REQUIRE(n_rounds >= 0 && steps_per_round > 0, "Invalid number of tempering steps");
+	NOTE("Parallel tempering");
+
+	Vector_<std::unique_ptr<Problem_>> problems(nChains);
+	Vector_<std::unique_ptr<Random_>> rands(nChains);
+	for (int ic = 0; ic < nChains; ++ic)
+	{
+		problems[ic].reset(problem.Clone());
+		rands[ic].reset(rand_src.Branch(ic));
+	}
+	std::unique_ptr<Random_> exchange(rand_src.Branch(nChains));
+	const double fInit = problems[0]->F(x_init);
+	Vector_<State_> chains;
+	for (int ic = 0; ic < nChains; ++ic)
+		chains.emplace_back(n_rounds * steps_per_round, x_init, fInit, temperatures[ic], half_life, *rands[ic]);
+	Vector_<pair<Vector_<>, double>> bests(nChains, chains[0].best_);
+
+	for (int iRound = 0; iRound < n_rounds; ++iRound)
+	{
+		Parallel::For(nChains, [&](int ic)
+		{
+			State_& chain = chains[ic];
+			Problem_& p = *problems[ic];
+			Vector_<> xTest;
+			for (int is = 0; is < steps_per_round; ++is)
+			{
+				p.Step(chain.best_.first, chain.tau_, chain.rands_, &xTest);
+				if (chain.Update(xTest, p.F(xTest)) && chain.best_.second < bests[ic].second)
+					bests[ic] = chain.best_;
+				(void) chain.Complete();
+			}
+		});
+		// replica exchange, alternating between even and odd pairs of neighbors
+			// accepted with probability min(1, exp((f_i - f_j)(1/tau_i - 1/tau_j))), which keeps each chain at its own equilibrium
+		for (int ic = iRound % 2; ic + 1 < nChains; ic += 2)
+		{
+			State_& lo = chains[ic];
+			State_& hi = chains[ic + 1];
+			const double logRatio = (lo.best_.second - hi.best_.second) * (1.0 / lo.tau_ - 1.0 / hi.tau_);
+			if (logRatio >= 0.0 || exchange->NextUniform() < exp(logRatio))
+				swap(lo.best_, hi.best_);
+		}
+	}
+
+	int iBest = 0;
+	for (int ic = 1; ic < nChains; ++ic)
+		if (bests[ic].second < bests[iBest].second)
+			iBest = ic;
+	return bests[iBest];
+}
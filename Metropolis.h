@@ -1,6 +1,8 @@
 
 // Implementation of Metropolis-style simulated annealing algorithms
 
+#pragma once
+
 #include "Vectors.h"
 #include "Random.h"
 
@@ -24,6 +26,29 @@ namespace Metropolis
 		}
 		bool Complete() { tau_ *= tauDecay_;  return nToGo_-- <= 0; }
 	};
+
+	// what parallel tempering needs from the problem; each chain works on its own clone, on its own thread
+	class Problem_ : noncopyable
+	{
+	public:
+		virtual ~Problem_();
+		virtual double F(const Vector_<>& x) = 0;
+		// a trial point near x; tau is the chain's temperature, so hotter chains can take larger steps
+		virtual void Step(const Vector_<>& x, double tau, Random_& rand, Vector_<>* x_test) = 0;
+		virtual Problem_* Clone() const = 0;
+	};
+
+	// runs one State_ per temperature, in parallel; after each round, neighboring chains offer to exchange states
+		// each chain has its own random stream, branched from rand_src, so the result does not depend on the number of threads
+		// returns the best point seen by any chain
+	pair<Vector_<>, double> Temper
+		(const Problem_& problem,
+		 const Vector_<>& x_init,
+		 const Vector_<>& temperatures,	// one chain per temperature, usually in geometric progression
+		 int n_rounds,
+		 int steps_per_round,	// Metropolis steps taken by each chain between exchanges
+		 const Random_& rand_src,
+		 double half_life = DA::INFINITY);	// in steps; all temperatures decay at the same rate
 }
 
 /* example usage:
@@ -0,0 +1,252 @@
+
+#include "Platform.h"
+#include "NearestCorrelation.h"
+#include "Strict.h"
+
+#include "Matrix.h"
+#include "Eispack.h"
+#include "Sparse.h"
+#include "BCG.h"
+#include "Numerics.h"
+#include "Functionals.h"
+#include "Exceptions.h"
+
+namespace
+{
+	// eigensystem of G + diag(y), which determines its projection onto the positive semidefinite cone
+	struct Spectrum_
+	{
+		Vector_<> lambda_;	// in descending order
+		Vector_<Vector_<>> u_;	// eigenvectors
+		int nPos_;	// number of positive eigenvalues
+
+		Spectrum_(const Matrix_<>& g, const Vector_<>& y)
+		{
+			Matrix_<> gy(g);
+			for (int ii = 0; ii < y.size(); ++ii)
+				gy(ii, ii) += y[ii];
+			Matrix_<> z;
+			Eispack::RS(gy, &lambda_, &z);
+			for (int ii = 0; ii < z.Cols(); ++ii)
+				u_.push_back(Copy(z.Col(ii)));
+			nPos_ = 0;
+			while (nPos_ < lambda_.size() && lambda_[nPos_] > 0.0)
+				++nPos_;
+		}
+
+		int Size() const { return lambda_.size(); }
+		Vector_<> ProjectedDiagonal() const
+		{
+			Vector_<> retval(Size(), 0.0);
+			for (int kk = 0; kk < nPos_; ++kk)
+				for (int ii = 0; ii < Size(); ++ii)
+					retval[ii] += lambda_[kk] * Square(u_[kk][ii]);
+			return retval;
+		}
+		double ProjectedNorm2() const
+		{
+			double retval = 0.0;
+			for (int kk = 0; kk < nPos_; ++kk)
+				retval += Square(lambda_[kk]);
+			return retval;
+		}
+		Matrix_<> Projection() const
+		{
+			const int n = Size();
+			Matrix_<> retval(n, n);
+			for (int kk = 0; kk < nPos_; ++kk)
+				for (int ii = 0; ii < n; ++ii)
+				{
+					const double lui = lambda_[kk] * u_[kk][ii];
+					auto row = retval.Row(ii);
+					Transform(&row, u_[kk], LinearIncrement(lui));
+				}
+			return retval;
+		}
+	};
+
+	// generalized Jacobian of the dual gradient:  d -> diag(P (Omega o (P^T diag(d) P)) P^T)
+		// Omega is 1 on the positive block, 0 on the nonpositive block, and lambda_k / (lambda_k - lambda_l) between them
+		// we write the product in terms of whichever eigenvalue set is smaller, so the cost is O(n^2 min(n_pos, n_neg))
+	class XNewtonMatrix_ : public Sparse::Square_, public HasPreconditioner_
+	{
+		const Spectrum_& s_;
+		bool byPositive_;	// else work from the complement, since P P^T = I
+		Matrix_<> omega_;	// mixed-block weights, shifted by -1 when !byPositive_
+		double reg_;
+		Vector_<> diag_;	// for the preconditioner
+
+		int Begin() const { return byPositive_ ? 0 : s_.nPos_; }
+		int End() const { return byPositive_ ? s_.nPos_ : s_.Size(); }
+	public:
+		XNewtonMatrix_(const Spectrum_& s, double reg)
+			: s_(s), byPositive_(2 * s.nPos_ <= s.Size()), omega_(s.nPos_, s.Size() - s.nPos_), reg_(reg)
+		{
+			const int n = s_.Size(), r = s_.nPos_;
+			for (int kk = 0; kk < r; ++kk)
+				for (int ll = r; ll < n; ++ll)
+					omega_(kk, ll - r) = s_.lambda_[kk] / (s_.lambda_[kk] - s_.lambda_[ll]) - (byPositive_ ? 0.0 : 1.0);
+
+			Vector_<> inS(n, 0.0), cross(n);
+			Vector_<Vector_<>> u2(n, Vector_<>(n));
+			for (int kk = 0; kk < n; ++kk)
+				Transform(s_.u_[kk], [](double u_i) { return u_i * u_i; }, &u2[kk]);
+			for (int kk = Begin(); kk < End(); ++kk)
+				inS += u2[kk];
+			diag_ = Vector_<>(n, byPositive_ ? reg_ : 1.0 + reg_);
+			Transform(&diag_, inS, [&](double d_i, double s_i) { return d_i + (byPositive_ ? 1.0 : -1.0) * s_i * s_i; });
+			for (int kk = 0; kk < r; ++kk)
+			{
+				cross.Fill(0.0);
+				for (int ll = r; ll < n; ++ll)
+					Transform(&cross, u2[ll], LinearIncrement(omega_(kk, ll - r)));
+				for (int ii = 0; ii < n; ++ii)
+					diag_[ii] += 2.0 * u2[kk][ii] * cross[ii];
+			}
+		}
+
+		int Size() const override { return s_.Size(); }
+		void MultiplyLeft(const Vector_<>& d, Vector_<>* vd) const override
+		{
+			const int n = s_.Size(), r = s_.nPos_;
+			*vd = byPositive_ ? Vector_<>(n, 0.0) : d;
+			Transform(vd, d, LinearIncrement(reg_));
+			Vector_<> ud(n), q(n);
+			// within-set block
+			for (int kk = Begin(); kk < End(); ++kk)
+			{
+				Transform(s_.u_[kk], d, std::multiplies<double>(), &ud);
+				q.Fill(0.0);
+				for (int ll = Begin(); ll < End(); ++ll)
+					Transform(&q, s_.u_[ll], LinearIncrement(InnerProduct(ud, s_.u_[ll])));
+				for (int ii = 0; ii < n; ++ii)
+					(*vd)[ii] += (byPositive_ ? 1.0 : -1.0) * s_.u_[kk][ii] * q[ii];
+			}
+			// mixed block, counted twice for symmetry
+			for (int kk = 0; kk < r; ++kk)
+			{
+				Transform(s_.u_[kk], d, std::multiplies<double>(), &ud);
+				q.Fill(0.0);
+				for (int ll = r; ll < n; ++ll)
+					Transform(&q, s_.u_[ll], LinearIncrement(omega_(kk, ll - r) * InnerProduct(ud, s_.u_[ll])));
+				for (int ii = 0; ii < n; ++ii)
+					(*vd)[ii] += 2.0 * s_.u_[kk][ii] * q[ii];
+			}
+		}
+		void MultiplyRight(const Vector_<>& d, Vector_<>* vd) const override { MultiplyLeft(d, vd); }
+		bool IsSymmetric() const override { return true; }
+		SquareMatrixDecomposition_* Decompose() const override { THROW("Newton matrix decomposition is not supported"); }
+		const double& operator()(int i_row, int i_col) const override { THROW("Newton matrix element access is not supported"); }
+		void Set(int i_row, int i_col, double val) override { THROW("Newton matrix element setting is not possible"); }
+
+		void PreconditionerSolveLeft(const Vector_<>& b, Vector_<>* x) const override
+		{
+			Transform(b, diag_, [](double b_i, double d_i) { return b_i / Max(d_i, DA::EPSILON); }, x);
+		}
+		void PreconditionerSolveRight(const Vector_<>& b, Vector_<>* x) const override { PreconditionerSolveLeft(b, x); }
+	};
+
+	double DualObjective(const Spectrum_& s, const Vector_<>& b, const Vector_<>& y)
+	{
+		return 0.5 * s.ProjectedNorm2() - InnerProduct(b, y);
+	}
+}	// leave local
+
+Matrix_<> NearestCorrelation
+	(const Matrix_<>& a,
+	 const Vector_<>& weights,
+	 double min_eigenvalue,
+	 double tol,
+	 Vector_<>* dual)
+{
+	static const int MAX_ITERATIONS = 100;
+	static const int MAX_BACKTRACKS = 30;
+	static const double ARMIJO = 1.0e-4;
+	static const double MIN_FORCING = 1.0e-10;	// floor on the inner solve tolerance and regularization, which otherwise vanish as we converge
+	const int n = a.Rows();
+	REQUIRE(a.Cols() == n, "Correlation matrix must be square");
+	REQUIRE(weights.empty() || weights.size() == n, "Weights must match correlation matrix size");
+	REQUIRE(AllOf(weights, IsPositive), "Weights must be positive");
+	REQUIRE(min_eigenvalue >= 0.0 && min_eigenvalue < 1.0, "Minimum eigenvalue must be in [0, 1)");
+	REQUIRE(tol > 0.0, "Tolerance must be positive");
+	if (n == 0)
+		return a;
+
+	// in scaled coordinates X' = W^{1/2} (X - min_eigenvalue I) W^{1/2}, we seek a PSD matrix with diagonal b
+		// shifting before weighting keeps the targets positive, and makes the floor exact for any weights
+	Vector_<> sqrtW(n, 1.0);
+	if (!weights.empty())
+		Transform(weights, [](double w) { return sqrt(w); }, &sqrtW);
+	Matrix_<> g(n, n);
+	for (int ii = 0; ii < n; ++ii)
+		for (int jj = 0; jj < n; ++jj)
+			g(ii, jj) = sqrtW[ii] * sqrtW[jj] * (0.5 * (a(ii, jj) + a(jj, ii)) - (ii == jj ? min_eigenvalue : 0.0));
+	Vector_<> b = Apply([&](double s_i) { return s_i * s_i * (1.0 - min_eigenvalue); }, sqrtW);
+
+	Vector_<> y;
+	if (dual && dual->size() == n)
+		y = *dual;
+	else
+	{
+		y = b;
+		for (int ii = 0; ii < n; ++ii)
+			y[ii] -= g(ii, ii);
+	}
+
+	std::unique_ptr<Spectrum_> s(new Spectrum_(g, y));
+	for (int iter = 0; ; ++iter)
+	{
+		Vector_<> f = s->ProjectedDiagonal();
+		f -= b;
+		if (fabs(*MaxElement(f)) <= tol && fabs(*MinElement(f)) <= tol)
+			break;
+		REQUIRE(iter < MAX_ITERATIONS, "Nearest correlation search failed to converge");
+		const double normF = Max(sqrt(InnerProduct(f, f)), MIN_FORCING);
+
+		// inexact Newton step solves V d = -F, accepting the best CG iterate if the iteration cap is reached
+		XNewtonMatrix_ v(*s, Min(1.0e-4, normF));
+		Vector_<> step(n, 0.0), rhs(f);
+		rhs *= -1.0;
+		Sparse::CGSolve(v, rhs, Min(0.1, normF), 0.0, 2 * n + 50, &step, nullptr, true);
+
+		// Armijo backtracking on the (convex) dual objective
+			// once the predicted decrease is below its rounding error, we are well inside the region of quadratic convergence and take the full step
+		const double theta = DualObjective(*s, b, y);
+		const double slope = InnerProduct(f, step);
+		const bool unresolved = -slope < DA::EPSILON * (1.0 + fabs(theta));
+		double alpha = 1.0;
+		bool stalled = true;
+		for (int iBacktrack = 0; iBacktrack < MAX_BACKTRACKS && stalled; ++iBacktrack, alpha *= 0.5)
+		{
+			Vector_<> yTrial(y);
+			Transform(&yTrial, step, LinearIncrement(alpha));
+			std::unique_ptr<Spectrum_> trial(new Spectrum_(g, yTrial));
+			if (unresolved || DualObjective(*trial, b, yTrial) <= theta + ARMIJO * alpha * slope)
+			{
+				y.Swap(&yTrial);
+				s.swap(trial);
+				stalled = false;
+			}
+		}
+		if (stalled)	// no further progress is possible at machine precision; the rescaling below absorbs the remaining error
+			break;
+	}
+
+	if (dual)
+		*dual = y;
+	Matrix_<> retval = s->Projection();
+	for (int ii = 0; ii < n; ++ii)
+	{
+		for (int jj = 0; jj < n; ++jj)
+			retval(ii, jj) /= sqrtW[ii] * sqrtW[jj];
+		retval(ii, ii) += min_eigenvalue;
+	}
+	// remove residual diagonal error; this congruence preserves positive semidefiniteness
+	Vector_<> scale(n);
+	for (int ii = 0; ii < n; ++ii)
+		scale[ii] = 1.0 / sqrt(Max(retval(ii, ii), DA::EPSILON));
+	for (int ii = 0; ii < n; ++ii)
+		for (int jj = 0; jj < n; ++jj)
+			retval(ii, jj) *= scale[ii] * scale[jj];
+	return retval;
+}
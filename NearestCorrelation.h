@@ -0,0 +1,14 @@
+// repair of matrices which should be, but are not, valid correlation matrices
+
+#pragma once
+
+#include "Vectors.h"
+
+// nearest (in the weighted Frobenius norm ||W^{1/2} (X - A) W^{1/2}||) symmetric positive semidefinite X with unit diagonal
+	// uses the dual Newton method of Qi and Sun; each iteration costs one full eigendecomposition
+Matrix_<> NearestCorrelation
+	(const Matrix_<>& a,	// symmetric
+	 const Vector_<>& weights = Vector_<>(),	// diagonal of W; empty means equal weights
+	 double min_eigenvalue = 0.0,	// floor on eigenvalues of the result, for any weights; lets it pass CholeskyDecomposition
+	 double tol = 1.0e-7,	// on the diagonal error of the result
+	 Vector_<>* dual = nullptr);	// if supplied and nonempty, used as a warm start; if supplied, returns the dual solution for the next call
@@ -0,0 +1,142 @@
+
+#include "Platform.h"
+#include "Parallel.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Strict.h"
+
+namespace
+{
+	// workers wait for jobs on a queue; never destroyed (see ThePool)
+	class Pool_ : noncopyable
+	{
+		std::vector<std::thread> workers_;
+		std::mutex mutex_;
+		std::condition_variable wake_;
+		std::deque<std::function<void()>> jobs_;
+
+		void Work()
+		{
+			for (;;)
+			{
+				std::function<void()> job;
+				{
+					std::unique_lock<std::mutex> l(mutex_);
+					wake_.wait(l, [&]() { return !jobs_.empty(); });
+					job.swap(jobs_.front());
+					jobs_.pop_front();
+				}
+				job();
+			}
+		}
+
+	public:
+		Pool_()
+		{
+			const int n = static_cast<int>(std::thread::hardware_concurrency());
+			for (int ii = 1; ii < n; ++ii)	// the calling thread is the other one
+				workers_.emplace_back([this]() { Work(); });
+		}
+		int Size() const { return static_cast<int>(workers_.size()) + 1; }
+		void Submit(const std::function<void()>& job)
+		{
+			{
+				std::lock_guard<std::mutex> l(mutex_);
+				jobs_.push_back(job);
+			}
+			wake_.notify_one();
+		}
+	};
+
+	// deliberately leaked:  joining the workers from a static destructor can deadlock when the library is unloaded under the loader lock
+		// the OS reclaims the threads at process exit
+	Pool_& ThePool()
+	{
+		static Pool_* const POOL = new Pool_;
+		return *POOL;
+	}
+
+	// shared by the caller and its helpers for the duration of one For
+		// helpers which start after the caller has finished do nothing, so the caller never waits on a queued job
+	struct Batch_
+	{
+		const std::function<void(int)>& task_;
+		const int nTasks_;
+		std::atomic<int> next_;
+		std::mutex mutex_;
+		std::condition_variable idle_;
+		int active_;
+		bool closed_;
+		std::exception_ptr error_;
+
+		Batch_(const std::function<void(int)>& task, int n_tasks) : task_(task), nTasks_(n_tasks), next_(0), active_(0), closed_(false) {}
+
+		void Drain()
+		{
+			for (int ii = next_++; ii < nTasks_; ii = next_++)
+			{
+				try
+				{
+					task_(ii);
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> l(mutex_);
+					if (!error_)
+						error_ = std::current_exception();
+					next_ = nTasks_;	// abandon unclaimed tasks
+				}
+			}
+		}
+		void Help()
+		{
+			{
+				std::lock_guard<std::mutex> l(mutex_);
+				if (closed_)
+					return;
+				++active_;
+			}
+			Drain();
+			std::lock_guard<std::mutex> l(mutex_);
+			if (--active_ == 0)
+				idle_.notify_all();
+		}
+		void Finish()
+		{
+			std::unique_lock<std::mutex> l(mutex_);
+			closed_ = true;
+			idle_.wait(l, [&]() { return active_ == 0; });
+		}
+	};
+}	// leave local
+
+int Parallel::NumThreads()
+{
+	return ThePool().Size();
+}
+
+void Parallel::For
+	(int n_tasks,
+	 const std::function<void(int)>& task,
+	 int max_threads)
+{
+	const int nThreads = Min(n_tasks, max_threads > 0 ? Min(max_threads, NumThreads()) : NumThreads());
+	if (nThreads <= 1)
+	{
+		for (int ii = 0; ii < n_tasks; ++ii)
+			task(ii);
+		return;
+	}
+	auto batch = std::make_shared<Batch_>(task, n_tasks);
+	for (int ii = 1; ii < nThreads; ++ii)
+		ThePool().Submit([batch]() { batch->Help(); });
+	batch->Drain();
+	batch->Finish();
+	if (batch->error_)
+		std::rethrow_exception(batch->error_);
+}
@@ -0,0 +1,19 @@
+// fork-join parallelism over independent tasks, on a shared pool of worker threads
+
+#pragma once
+
+#include <functional>
+
+namespace Parallel
+{
+	int NumThreads();	// size of the shared pool, including the calling thread
+
+	// calls task(ii) for each ii in [0, n_tasks), returning when all have completed
+		// tasks are claimed dynamically in index order, so putting the most expensive first balances uneven work
+		// the calling thread participates, and nested calls are safe (they may run serially)
+		// the first exception thrown by any task is rethrown here, after the others have stopped
+	void For
+		(int n_tasks,
+		 const std::function<void(int)>& task,
+		 int max_threads = 0);	// 0 means NumThreads()
+}
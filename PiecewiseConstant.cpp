@@ -58,3 +58,41 @@ double PWC::F
 			: pwc.fRight_[iGE - 1];
 }
 
+
+PWC::Grid_::Grid_(const PiecewiseConstant_& func, const Vector_<DateTime_>& times)
+	:
+func_(func),
+times_(times),
+iLE_(times.size()),
+elapsed_(times.size())
+{
+	// visit times in increasing order, walking the knots alongside
+	Vector_<int> order(times_.size());
+	for (int ii = 0; ii < order.size(); ++ii)
+		order[ii] = ii;
+	if (!IsMonotonic(times_, std::less_equal<DateTime_>()))
+		Sort(&order, [&](int i, int j) { return times_[i] < times_[j]; });
+	const Vector_<DateTime_>& knots = func_.knotDates_;
+	int k = -1;
+	for (auto ii : order)
+	{
+		while (k + 1 < knots.size() && knots[k + 1] <= times_[ii])
+			++k;
+		iLE_[ii] = k;
+		elapsed_[ii] = k < 0 ? 0.0 : times_[ii] - knots[k];
+	}
+}
+
+void PWC::Grid_::F(Vector_<>* vals) const
+{
+	vals->Resize(Size());
+	for (int ii = 0; ii < Size(); ++ii)
+		(*vals)[ii] = F(ii);
+}
+
+void PWC::Grid_::IntegralTo(Vector_<>* vals) const
+{
+	vals->Resize(Size());
+	for (int ii = 0; ii < Size(); ++ii)
+		(*vals)[ii] = IntegralTo(ii);
+}
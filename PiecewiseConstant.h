@@ -48,6 +48,31 @@ namespace PWC
 		return func.IntegralTo(to) - func.IntegralTo(from);
 	}
 
+	// query times resolved once to knot intervals, so values and integrals at them need no search
+		// reads the function's values on each call, so stays valid if they change (but not if its knots do)
+	class Grid_
+	{
+		const PiecewiseConstant_& func_;
+		Vector_<DateTime_> times_;
+		Vector_<int> iLE_;	// last knot on-or-before each time, or -1 if none
+		Vector_<> elapsed_;	// time since that knot
+	public:
+		Grid_(const PiecewiseConstant_& func, const Vector_<DateTime_>& times);	// times may be in any order; sorted times skip a sort
+		int Size() const { return times_.size(); }
+		const Vector_<DateTime_>& Times() const { return times_; }
+
+		double F(int i_time) const { return iLE_[i_time] < 0 ? 0.0 : func_.fRight_[iLE_[i_time]]; }
+		double IntegralTo(int i_time) const
+		{
+			const int k = iLE_[i_time];
+			return k < 0 ? 0.0 : func_.sofar_[k] + elapsed_[i_time] * func_.fRight_[k];
+		}
+		double Integral(int i_from, int i_to) const { return IntegralTo(i_to) - IntegralTo(i_from); }
+		// values at all times, in a single pass
+		void F(Vector_<>* vals) const;
+		void IntegralTo(Vector_<>* vals) const;
+	};
+
 	inline PiecewiseConstant_* NewConstant
 		(double val,
 		 const DateTime_& from = DateTime::Minimum())
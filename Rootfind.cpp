@@ -3,6 +3,8 @@
 #include "Rootfind.h"
 #include "Strict.h"
 
+#include "Exceptions.h"
+
 Rootfinder_::~Rootfinder_()
 {	}
 
@@ -122,3 +124,104 @@ double Brent_::BracketWidth() const
 		: DA::INFINITY;
 }
 
+
+// Newton with bisection safeguard, after rtsafe in Numerical Recipes
+
+BracketedNewton_::BracketedNewton_
+	(const pair<double, double>& low,
+	const pair<double, double>& high)
+:
+low_(low.first),
+high_(high.first),
+fLow_(low.second)
+{
+	assert(low.second * high.second <= 0.0);
+	// start from the secant point, which lies within the bracket
+	x_ = low.second == high.second
+		? 0.5 * (low_ + high_)
+		: (low_ * high.second - high_ * low.second) / (high.second - low.second);
+	dx_ = dxOld_ = fabs(high_ - low_);
+}
+
+void BracketedNewton_::Narrow(double y)
+{
+	(y * fLow_ > 0.0 ? low_ : high_) = x_;
+}
+
+void BracketedNewton_::Bisect()
+{
+	dxOld_ = dx_;
+	const double mid = 0.5 * (low_ + high_);
+	dx_ = fabs(x_ - mid);
+	x_ = mid;
+}
+
+void BracketedNewton_::PutY(double y)
+{
+	Narrow(y);
+	Bisect();
+}
+
+void BracketedNewton_::PutYAndSlope(double y, double dy_dx)
+{
+	Narrow(y);
+	const double s = x_ - y / dy_dx;	// comparisons below are false if dy_dx is zero
+	if ((s - low_) * (s - high_) < 0.0 && fabs(2.0 * y) <= fabs(dxOld_ * dy_dx))
+	{
+		dxOld_ = dx_;
+		dx_ = fabs(s - x_);
+		x_ = s;
+	}
+	else
+		Bisect();
+}
+
+double BracketedNewton_::BracketWidth() const
+{
+	return Min(fabs(high_ - low_), dx_);
+}
+
+// lockstep driver
+
+Vector_<> Rootfind::Solve
+	(const Vector_<Rootfinder_*>& tasks,
+	 const Vector_<Converged_>& checks,
+	 const Batch_& f,
+	 int max_iterations,
+	 bool with_slope)
+{
+	const int n = tasks.size();
+	REQUIRE(checks.size() == n || checks.size() == 1, "Need one convergence check per task, or a single shared one");
+	Vector_<> retval(n);
+	Vector_<int> active;
+	for (int ii = 0; ii < n; ++ii)
+		active.push_back(ii);
+	Vector_<> x, y, dy;
+	for (int iRound = 0; !active.empty(); ++iRound)
+	{
+		REQUIRE(iRound < max_iterations, "Exhausted iterations in batch rootfinding");
+		x.Resize(active.size());
+		for (int kk = 0; kk < active.size(); ++kk)
+			x[kk] = tasks[active[kk]]->NextX();
+		y.Resize(active.size());
+		dy.Resize(with_slope ? active.size() : 0);
+		f(x, active, &y, with_slope ? &dy : nullptr);
+		REQUIRE(y.size() == active.size() && dy.size() == (with_slope ? active.size() : 0), "Batch objective returned the wrong number of values");
+
+		// retire converged problems, keeping the rest in order
+		int nKeep = 0;
+		for (int kk = 0; kk < active.size(); ++kk)
+		{
+			const int ii = active[kk];
+			retval[ii] = x[kk];
+			const Converged_& check = checks[checks.size() == 1 ? 0 : ii];
+			const bool done = with_slope
+				? check(*tasks[ii], y[kk], dy[kk])
+				: check(*tasks[ii], y[kk]);
+			if (!done)
+				active[nKeep++] = ii;
+		}
+		active.Resize(nKeep);
+	}
+	return retval;
+}
@@ -3,6 +3,9 @@
 
 #pragma once
 
+#include <functional>
+#include "Vectors.h"
+
 class Rootfinder_
 {
 public:
@@ -10,6 +13,8 @@ public:
 	virtual double NextX() = 0;
 	virtual void PutY(double y) = 0;
 	virtual double BracketWidth() const = 0;
+	// for searches which can use the slope dy/dx; by default it is ignored
+	virtual void PutYAndSlope(double y, double dy_dx) { PutY(y); }
 };
 
 // convergence-checking utility
@@ -22,6 +27,11 @@ struct Converged_
 		t.PutY(e);
 		return fabs(e) < ftol_ || t.BracketWidth() < xtol_;
 	}
+	bool operator()(Rootfinder_& t, double e, double de_dx) const
+	{
+		t.PutYAndSlope(e, de_dx);
+		return fabs(e) < ftol_ || t.BracketWidth() < xtol_;
+	}
 };
 
 // helper for mapping reals to positive reals
@@ -75,3 +85,41 @@ public:
 	double BracketWidth() const override;
 };
 
+
+// Newton's method, safeguarded by bisection when the step leaves the bracket or is not shrinking fast enough
+	// needs PutYAndSlope; given only PutY, it bisects
+class BracketedNewton_ : public Rootfinder_
+{
+	double low_, high_;	// the objective has the sign of fLow_ at low_
+	double fLow_;
+	double x_;	// the next (and, until the next PutY, the last) trial point
+	double dx_, dxOld_;	// the last two steps
+	void Narrow(double y);
+	void Bisect();
+public:
+	BracketedNewton_
+		(const pair<double, double>& low,
+		 const pair<double, double>& high);
+
+	double NextX() override { return x_; }
+	void PutY(double y) override;
+	void PutYAndSlope(double y, double dy_dx) override;
+	double BracketWidth() const override;	// the last Newton step, if that is smaller
+};
+
+// lockstep search for many independent roots
+	// each round hands the trial points of all unconverged problems to the objective at once, so it can amortize its setup and vectorize its loop
+namespace Rootfind
+{
+	// fills y (and dy_dx, unless it is null) at the points x, where x[k] is a trial for problem which[k]
+	typedef std::function<void(const Vector_<>& x, const Vector_<int>& which, Vector_<>* y, Vector_<>* dy_dx)> Batch_;
+
+	// returns the final x of each task; converged tasks drop out of later rounds
+		// throws if any task is unconverged after max_iterations rounds
+	Vector_<> Solve
+		(const Vector_<Rootfinder_*>& tasks,	// not owned
+		 const Vector_<Converged_>& checks,	// one per task, or one shared by all
+		 const Batch_& f,
+		 int max_iterations,
+		 bool with_slope = false);	// if set, f must fill dy_dx
+}
@@ -4,7 +4,9 @@
 #include "Strict.h"
 
 #include "Sparse.h"
+#include "SparseCholesky.h"
 #include "Algorithms.h"
+#include "Exceptions.h"
 
 namespace
 {
@@ -20,7 +22,7 @@ namespace
 	{
 		if (i_row == i_col)
 			return &diag[i_row];
-		auto row = off_diag[i_row];
+		auto& row = off_diag[i_row];
 		for (auto pe = row.begin(); pe != row.end(); ++pe)
 			if (pe->first == i_col)
 				return &pe->second;
@@ -31,6 +33,7 @@ namespace
 	{
 		Vector_<> diag_;
 		Vector_<Vector_<pair<int, double> > > offDiag_;
+		mutable Handle_<Sparse::CholeskySymbolic_> symbolic_;	// reused until the pattern changes
 
 		template<bool transpose> void XMultiply
 			(const Vector_<>& x,
@@ -46,9 +49,36 @@ namespace
 						(*b)[transpose ? l_v.first : ii] += l_v.second * x[transpose ? ii : l_v.first];
 		}
 
+	public:
+		SlapMatrix_(int size) : diag_(size, 0.0), offDiag_(size) {}
+
+		int Size() const override { return diag_.size(); }
 		void MultiplyLeft(const Vector_<>& x, Vector_<>* b) const override { XMultiply<false>(x, b); }
 		void MultiplyRight(const Vector_<>& x, Vector_<>* b) const override { XMultiply<true>(x, b); }
 
+		bool IsSymmetric() const override
+		{
+			for (int ii = 0; ii < Size(); ++ii)
+				for (const auto& l_v : offDiag_[ii])
+					if (!IsZero(l_v.second - operator()(l_v.first, ii)))
+						return false;
+			return true;
+		}
+		SquareMatrixDecomposition_* Decompose() const override
+		{
+			REQUIRE(IsSymmetric(), "Cholesky decomposition requires a symmetric matrix");
+			// POSTPONED -- return sparse LU decomposition
+			if (symbolic_.Empty())
+			{
+				Vector_<Vector_<int>> pattern(Size());
+				for (int ii = 0; ii < Size(); ++ii)
+					for (const auto& l_v : offDiag_[ii])
+						pattern[ii].push_back(l_v.first);
+				symbolic_.reset(new Sparse::CholeskySymbolic_(pattern));
+			}
+			return Sparse::NewSparseCholesky(*this, symbolic_);
+		}
+
 		const double& operator()(int i_row, int i_col) const override
 		{
 			const double* temp = SLAPElement(diag_, offDiag_, i_row, i_col);
@@ -59,15 +89,27 @@ namespace
 			if (double* dst = SLAPElement(diag_, offDiag_, i_row, i_col))
 				*dst = val;
 			else
+			{
 				offDiag_[i_row].emplace_back(i_col, val);
+				symbolic_.reset();
+			}
 		}
 		void Add(int i_row, int i_col, double val) override
 		{
 			if (double* dst = SLAPElement(diag_, offDiag_, i_row, i_col))
 				*dst += val;
 			else
+			{
 				offDiag_[i_row].emplace_back(i_col, val);
+				symbolic_.reset();
+			}
 		}
 	};
 }	// leave local
 
+Sparse::Square_* Sparse::NewSLAP(int size)
+{
+	assert(size > 0);
+	return new SlapMatrix_(size);
+}
+
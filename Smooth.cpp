@@ -5,7 +5,9 @@
 #include "Strict.h"
 
 #include "Vectors.h"
+#include "Matrix.h"
 #include "Algorithms.h"
+#include "Exceptions.h"
 
 // smoothing spline z-vals
 Vector_<> SmoothedVals
@@ -13,33 +15,108 @@ Vector_<> SmoothedVals
 	 const Vector_<>& y,
 	 const Vector_<>& weight,	// if empty, all weights are 1.0
 	 double lambda)
+{
+	return Smooth::Smoother_(x, weight, lambda)(y);
+}
+
+// the system is tridiagonal with diagonal w_i + coupling_{i-1} + coupling_i and off-diagonal -coupling_i
+	// each lambda needs its own O(n) factorization; we keep it, with the hat-matrix trace, for reuse across y
+Smooth::Smoother_::Smoother_
+	(const Vector_<>& x,
+	 const Vector_<>& weight,
+	 double lambda)
+	:
+w_(weight.empty() ? Vector_<>(x.size(), 1.0) : weight),
+coupling_(x.size()),
+pivot_(x.size())
 {
 	static const double DX_MIN = 1.0e-9;
 
 	assert(IsMonotonic(x, std::less_equal<double>()));
 	const int n = x.size();
-	assert(y.size() == n && n > 1);
-	// populate the couplings in advance
-	Vector_<> coupling(n);
+	assert(w_.size() == n && n > 1);
 	for (int ii = 1; ii < n; ++ii)
-		coupling[ii - 1] = lambda / Max(x[ii] - x[ii - 1], DX_MIN);
-	coupling.back() = 0.0;	// simplifies loop
+		coupling_[ii - 1] = lambda / Max(x[ii] - x[ii - 1], DX_MIN);
+	coupling_.back() = 0.0;	// simplifies loops
 
-	Vector_<> beta(n), gamma(n);
-	// initialize forward recursion
-	beta[0] = (weight.empty() ? 1.0 : weight[0]) + coupling[0];
-	gamma[0] = (weight.empty() ? 1.0 : weight[0]) * y[0];
+	auto diag = [&](int ii) { return w_[ii] + (ii > 0 ? coupling_[ii - 1] : 0.0) + coupling_[ii]; };
+	pivot_[0] = diag(0);
 	for (int ii = 1; ii < n; ++ii)
+		pivot_[ii] = diag(ii) - Square(coupling_[ii - 1]) / pivot_[ii - 1];
+
+	// diagonal of the inverse from the forward and backward pivots:  1 / (fwd_i + bwd_i - diag_i)
+	trace_ = 0.0;
+	double backward = diag(n - 1);
+	for (int ii = n - 1; ; --ii)
 	{
-		const double w = weight.empty() ? 1.0 : weight[ii];
-		gamma[ii] = w * y[ii] + coupling[ii - 1] * gamma[ii - 1] / beta[ii - 1];
-		beta[ii] = w + coupling[ii - 1] + coupling[ii] - Square(coupling[ii - 1]) / beta[ii - 1];	// at end of loop, coupling[ii] is zero because it doesn't exist
+		trace_ += w_[ii] / (pivot_[ii] + backward - diag(ii));
+		if (ii == 0)
+			break;
+		backward = diag(ii - 1) - Square(coupling_[ii - 1]) / backward;
 	}
-	// backsubstitution for final result
+}
+
+Vector_<> Smooth::Smoother_::operator()(const Vector_<>& y) const
+{
+	const int n = Size();
+	REQUIRE(y.size() == n, "Smoothing data must match grid size");
 	Vector_<> z(n);
-	z.back() = gamma.back() / beta.back();
+	z[0] = w_[0] * y[0];
+	for (int ii = 1; ii < n; ++ii)
+		z[ii] = w_[ii] * y[ii] + coupling_[ii - 1] * z[ii - 1] / pivot_[ii - 1];
+	z.back() /= pivot_.back();
 	for (int jj = n - 2; jj >= 0; --jj)
-		z[jj] = (gamma[jj] + coupling[jj] * z[jj + 1]) / beta[jj];
+		z[jj] = (z[jj] + coupling_[jj] * z[jj + 1]) / pivot_[jj];
 	return z;
 }
 
+void Smooth::Smoother_::operator()(const Matrix_<>& ys, Matrix_<>* zs) const
+{
+	REQUIRE(ys.Cols() == Size(), "Smoothing data must match grid size");
+	zs->Resize(ys.Rows(), ys.Cols());
+	for (int ir = 0; ir < ys.Rows(); ++ir)
+	{
+		auto dst = zs->Row(ir);
+		Copy((*this)(Copy(ys.Row(ir))), &dst);
+	}
+}
+
+double Smooth::Smoother_::GCV(const Vector_<>& y, const Vector_<>& z) const
+{
+	const int n = Size();
+	double rss = 0.0;
+	for (int ii = 0; ii < n; ++ii)
+		rss += w_[ii] * Square(y[ii] - z[ii]);
+	return n * rss / Square(n - trace_);
+}
+
+Vector_<> Smooth::GCVLambda
+	(const Vector_<>& x,
+	 const Matrix_<>& ys,
+	 const Vector_<>& weight,
+	 const Vector_<>& lambdas,
+	 Matrix_<>* scores)
+{
+	REQUIRE(!lambdas.empty(), "No smoothing lambdas to choose from");
+	const int nY = ys.Rows();
+	Vector_<> retval(nY), best(nY, DA::INFINITY);
+	if (scores)
+		scores->Resize(nY, lambdas.size());
+	for (int il = 0; il < lambdas.size(); ++il)
+	{
+		const Smoother_ smoother(x, weight, lambdas[il]);
+		for (int iy = 0; iy < nY; ++iy)
+		{
+			const Vector_<> y = Copy(ys.Row(iy));
+			const double score = smoother.GCV(y, smoother(y));
+			if (scores)
+				(*scores)(iy, il) = score;
+			if (score < best[iy])
+			{
+				best[iy] = score;
+				retval[iy] = lambdas[il];
+			}
+		}
+	}
+	return retval;
+}
@@ -1,8 +1,9 @@
-
 // smoothing splines
 
 #pragma once
 
+#include "Vectors.h"
+
 // raw function to compute z-vals used in smoothing spline
 	// assumes x are sorted and distinct
 Vector_<> SmoothedVals
@@ -10,3 +11,36 @@ Vector_<> SmoothedVals
 	 const Vector_<>& y,
 	 const Vector_<>& weight,	// if empty, all weights are 1.0
 	 double lambda);
+
+namespace Smooth
+{
+	// the smoother of SmoothedVals at one lambda, factored once and applied to any number of y
+		// z minimizes sum w_i (z_i - y_i)^2 + lambda sum (z_{i+1} - z_i)^2 / (x_{i+1} - x_i)
+	class Smoother_ : noncopyable
+	{
+		Vector_<> w_;
+		Vector_<> coupling_;	// lambda / dx, with a trailing zero
+		Vector_<> pivot_;	// of the forward elimination
+		double trace_;	// of the hat matrix, which maps y to z
+	public:
+		Smoother_
+			(const Vector_<>& x,
+			 const Vector_<>& weight,	// if empty, all weights are 1.0
+			 double lambda);
+		int Size() const { return w_.size(); }
+		Vector_<> operator()(const Vector_<>& y) const;
+		void operator()(const Matrix_<>& ys, Matrix_<>* zs) const;	// each row of ys is one y
+
+		double HatTrace() const { return trace_; }
+		// generalized cross-validation score of a fit; smaller is better
+		double GCV(const Vector_<>& y, const Vector_<>& z) const;
+	};
+
+	// the lambda with the best GCV score for each y (each row of ys); ties go to the first in lambdas
+	Vector_<> GCVLambda
+		(const Vector_<>& x,
+		 const Matrix_<>& ys,
+		 const Vector_<>& weight,
+		 const Vector_<>& lambdas,
+		 Matrix_<>* scores = nullptr);	// if supplied, returns scores by (y, lambda)
+}
@@ -0,0 +1,302 @@
+
+#include "Platform.h"
+#include "SparseCholesky.h"
+#include <set>
+#include "Strict.h"
+
+#include "Sparse.h"
+#include "SquareMatrix.h"
+#include "Algorithms.h"
+#include "Numerics.h"
+#include "Exceptions.h"
+
+namespace
+{
+	// symmetric, sorted, diagonal-free adjacency lists
+	Vector_<Vector_<int>> Adjacency(const Vector_<Vector_<int>>& pattern)
+	{
+		const int n = pattern.size();
+		Vector_<Vector_<int>> retval(n);
+		for (int jj = 0; jj < n; ++jj)
+		{
+			for (auto ii : pattern[jj])
+			{
+				REQUIRE(ii >= 0 && ii < n, "Sparse pattern index out of range");
+				if (ii != jj)
+				{
+					retval[ii].push_back(jj);
+					retval[jj].push_back(ii);
+				}
+			}
+		}
+		for (auto& a : retval)
+			a = Unique(a);
+		return retval;
+	}
+
+	// minimum-degree ordering on the explicit elimination graph
+		// ties go to the lowest index, so the ordering is deterministic
+	Vector_<int> MinimumDegree(Vector_<Vector_<int>> adj)
+	{
+		const int n = adj.size();
+		std::set<pair<int, int>> byDegree;
+		for (int ii = 0; ii < n; ++ii)
+			byDegree.insert(make_pair(adj[ii].size(), ii));
+		Vector_<int> retval;
+		Vector_<int> merged;
+		while (!byDegree.empty())
+		{
+			const int p = byDegree.begin()->second;
+			byDegree.erase(byDegree.begin());
+			retval.push_back(p);
+			// p's neighbors become a clique
+			const Vector_<int>& clique = adj[p];
+			for (auto q : clique)
+			{
+				byDegree.erase(make_pair(adj[q].size(), q));
+				merged.clear();
+				std::set_union(adj[q].begin(), adj[q].end(), clique.begin(), clique.end(), std::back_inserter(merged));
+				merged.erase(std::remove_if(merged.begin(), merged.end(), [&](int r) { return r == p || r == q; }), merged.end());
+				adj[q].Swap(&merged);
+				byDegree.insert(make_pair(adj[q].size(), q));
+			}
+			adj[p].clear();
+		}
+		return retval;
+	}
+
+	// nonzero pattern of row k of L, in topological order, left in stack[top, n)
+	int ERow
+		(const Sparse::CholeskySymbolic_& s,
+		 int k,
+		 Vector_<int>* stack,
+		 Vector_<int>* mark)	// entries equal to k are marked
+	{
+		const int n = s.Size();
+		int top = n;
+		(*mark)[k] = k;
+		for (int pc = s.cStart_[k]; pc < s.cStart_[k + 1]; ++pc)
+		{
+			int len = 0;
+			for (int ii = s.cRow_[pc]; (*mark)[ii] != k; ii = s.parent_[ii])
+			{
+				(*stack)[len++] = ii;	// the bottom of the stack is free during this traversal
+				(*mark)[ii] = k;
+			}
+			while (len > 0)
+				(*stack)[--top] = (*stack)[--len];
+		}
+		return top;
+	}
+}	// leave local
+
+Sparse::CholeskySymbolic_::CholeskySymbolic_(const Vector_<Vector_<int>>& pattern)
+{
+	NOTE("Sparse Cholesky symbolic analysis");
+	const Vector_<Vector_<int>> adj = Adjacency(pattern);
+	const int n = adj.size();
+	perm_ = MinimumDegree(adj);
+	inv_.Resize(n);
+	for (int kk = 0; kk < n; ++kk)
+		inv_[perm_[kk]] = kk;
+
+	// upper triangle of P A P^T, excluding the diagonal
+	cStart_.Resize(n + 1);
+	cStart_[0] = 0;
+	for (int kk = 0; kk < n; ++kk)
+	{
+		for (auto jj : adj[perm_[kk]])
+			if (inv_[jj] < kk)
+				cRow_.push_back(inv_[jj]);
+		std::sort(cRow_.begin() + cStart_[kk], cRow_.end());
+		cStart_[kk + 1] = cRow_.size();
+	}
+
+	// elimination tree, with path compression through ancestor
+	parent_ = Vector_<int>(n, -1);
+	Vector_<int> ancestor(n, -1);
+	for (int kk = 0; kk < n; ++kk)
+	{
+		for (int pc = cStart_[kk]; pc < cStart_[kk + 1]; ++pc)
+		{
+			for (int ii = cRow_[pc]; ii != -1 && ii < kk; )
+			{
+				const int next = ancestor[ii];
+				ancestor[ii] = kk;
+				if (next == -1)
+					parent_[ii] = kk;
+				ii = next;
+			}
+		}
+	}
+
+	// column counts of L, by traversing the row subtrees
+	Vector_<int> counts(n, 1), stack(n), mark(n, -1);
+	for (int kk = 0; kk < n; ++kk)
+		for (int top = ERow(*this, kk, &stack, &mark); top < n; ++top)
+			++counts[stack[top]];
+	lStart_.Resize(n + 1);
+	lStart_[0] = 0;
+	for (int kk = 0; kk < n; ++kk)
+		lStart_[kk + 1] = lStart_[kk] + counts[kk];
+}
+
+namespace
+{
+	class SparseCholesky_ : public Sparse::SymmetricDecomposition_
+	{
+		Handle_<Sparse::CholeskySymbolic_> s_;
+		Vector_<int> lRow_;
+		Vector_<> lVal_;
+
+		// x <- L^{-1} x and x <- L^{-T} x, in permuted coordinates
+		void ForwardSolve(Vector_<>* x) const
+		{
+			const int n = s_->Size();
+			for (int jj = 0; jj < n; ++jj)
+			{
+				const double xj = ((*x)[jj] /= lVal_[s_->lStart_[jj]]);
+				if (xj != 0.0)
+					for (int pl = s_->lStart_[jj] + 1; pl < s_->lStart_[jj + 1]; ++pl)
+						(*x)[lRow_[pl]] -= lVal_[pl] * xj;
+			}
+		}
+		void BackSolve(Vector_<>* x) const
+		{
+			for (int jj = s_->Size() - 1; jj >= 0; --jj)
+			{
+				double xj = (*x)[jj];
+				for (int pl = s_->lStart_[jj] + 1; pl < s_->lStart_[jj + 1]; ++pl)
+					xj -= lVal_[pl] * (*x)[lRow_[pl]];
+				(*x)[jj] = xj / lVal_[s_->lStart_[jj]];
+			}
+		}
+		// b <- L x and b <- L^T x, in permuted coordinates
+		void MultiplyL(const Vector_<>& x, Vector_<>* b) const
+		{
+			const int n = s_->Size();
+			b->Resize(n);
+			b->Fill(0.0);
+			for (int jj = 0; jj < n; ++jj)
+				for (int pl = s_->lStart_[jj]; pl < s_->lStart_[jj + 1]; ++pl)
+					(*b)[lRow_[pl]] += lVal_[pl] * x[jj];
+		}
+		void MultiplyLT(const Vector_<>& x, Vector_<>* b) const
+		{
+			const int n = s_->Size();
+			b->Resize(n);
+			for (int jj = 0; jj < n; ++jj)
+			{
+				double bj = 0.0;
+				for (int pl = s_->lStart_[jj]; pl < s_->lStart_[jj + 1]; ++pl)
+					bj += lVal_[pl] * x[lRow_[pl]];
+				(*b)[jj] = bj;
+			}
+		}
+		template<class C_> Vector_<> Permuted(const C_& x) const
+		{
+			Vector_<> retval(x.size());
+			for (int kk = 0; kk < retval.size(); ++kk)
+				retval[kk] = x[s_->perm_[kk]];
+			return retval;
+		}
+		void Unpermute(const Vector_<>& y, Vector_<>* x) const
+		{
+			x->Resize(y.size());
+			for (int kk = 0; kk < y.size(); ++kk)
+				(*x)[s_->perm_[kk]] = y[kk];
+		}
+
+		void XMultiply_af(const Vector_<>& x, Vector_<>* b) const override
+		{
+			Vector_<> temp;
+			MultiplyLT(Permuted(x), &temp);
+			Vector_<> y;
+			MultiplyL(temp, &y);
+			Unpermute(y, b);
+		}
+		void XSolve_af(const Vector_<>& b, Vector_<>* x) const override
+		{
+			Vector_<> y = Permuted(b);
+			ForwardSolve(&y);
+			BackSolve(&y);
+			Unpermute(y, x);
+		}
+
+	public:
+		SparseCholesky_(const Sparse::Square_& a, const Handle_<Sparse::CholeskySymbolic_>& symbolic)
+			: s_(symbolic), lRow_(symbolic->FactorNonzeros()), lVal_(symbolic->FactorNonzeros())
+		{
+			NOTE("Sparse Cholesky numeric factorization");
+			const Sparse::CholeskySymbolic_& s = *s_;
+			const int n = s.Size();
+			REQUIRE(a.Size() == n, "Matrix size does not match Cholesky symbolic analysis");
+			// up-looking:  row k of L solves a triangular system in the previous rows
+			Vector_<int> next(s.lStart_.begin(), s.lStart_.end() - 1), stack(n), mark(n, -1);
+			Vector_<> x(n, 0.0);
+			for (int kk = 0; kk < n; ++kk)
+			{
+				const int top = ERow(s, kk, &stack, &mark);
+				const int ik = s.perm_[kk];
+				for (int pc = s.cStart_[kk]; pc < s.cStart_[kk + 1]; ++pc)
+					x[s.cRow_[pc]] = a(s.perm_[s.cRow_[pc]], ik);
+				double d = a(ik, ik);
+				for (int pt = top; pt < n; ++pt)
+				{
+					const int ii = stack[pt];
+					const double lki = x[ii] / lVal_[s.lStart_[ii]];
+					x[ii] = 0.0;
+					for (int pl = s.lStart_[ii] + 1; pl < next[ii]; ++pl)
+						x[lRow_[pl]] -= lVal_[pl] * lki;
+					d -= lki * lki;
+					const int pl = next[ii]++;
+					lRow_[pl] = kk;
+					lVal_[pl] = lki;
+				}
+				REQUIRE(d > 0.0, "Sparse Cholesky decomposition failed:  matrix is not positive definite");
+				const int pl = next[kk]++;
+				lRow_[pl] = kk;
+				lVal_[pl] = sqrt(d);
+			}
+		}
+
+		int Size() const override { return s_->Size(); }
+
+		Vector_<>::const_iterator MakeCorrelated
+			(Vector_<>::const_iterator iid_begin,
+			 Vector_<>* correlated)
+		const override
+		{
+			const int n = Size();
+			Vector_<> y;
+			MultiplyL(Vector_<>(iid_begin, iid_begin + n), &y);
+			Unpermute(y, correlated);
+			return iid_begin + n;
+		}
+
+		// J A^{-1} J^T = (L^{-1} P J^T)^T (L^{-1} P J^T) -- one forward solve per row of J
+		void QForm
+			(const Matrix_<>& j,
+			 SquareMatrix_<>* form)
+		const override
+		{
+			const int nj = j.Rows();
+			form->Resize(nj);
+			Vector_<Vector_<>> y(nj);
+			for (int ii = 0; ii < nj; ++ii)
+			{
+				y[ii] = Permuted(j.Row(ii));
+				ForwardSolve(&y[ii]);
+				for (int kk = 0; kk <= ii; ++kk)
+					(*form)(ii, kk) = (*form)(kk, ii) = InnerProduct(y[ii], y[kk]);
+			}
+		}
+	};
+}	// leave local
+
+Sparse::SymmetricDecomposition_* Sparse::NewSparseCholesky
+	(const Square_& a,
+	 const Handle_<CholeskySymbolic_>& symbolic)
+{
+	return new SparseCholesky_(a, symbolic);
+}
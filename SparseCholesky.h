@@ -0,0 +1,35 @@
+// Cholesky decomposition of general sparse symmetric matrices, with fill-reducing ordering
+
+#pragma once
+
+#include "Vectors.h"
+
+namespace Sparse
+{
+	class Square_;
+	class SymmetricDecomposition_;
+
+	// ordering and nonzero structure of the factor, which depend only on the pattern of the matrix
+		// so can be computed once and shared by all matrices with the same pattern
+	class CholeskySymbolic_ : noncopyable
+	{
+	public:
+		// pattern[j] lists the i != j where A(i, j) may be nonzero; it may be unsorted, and may list either or both of (i, j) and (j, i)
+		CholeskySymbolic_(const Vector_<Vector_<int>>& pattern);
+
+		int Size() const { return perm_.size(); }
+		int FactorNonzeros() const { return lStart_.back(); }
+
+		Vector_<int> perm_;	// perm_[k] is the original index of the k'th pivot (minimum-degree order)
+		Vector_<int> inv_;	// inverse of perm_
+		Vector_<int> parent_;	// elimination tree of the permuted matrix, -1 at roots
+		// upper triangle of the permuted matrix, by columns:  rows cRow_[cStart_[k], cStart_[k + 1]) of column k
+		Vector_<int> cStart_, cRow_;
+		Vector_<int> lStart_;	// column starts of the factor L, with its diagonal element first in each column
+	};
+
+	// the matrix must be positive definite, with nonzeros only where the symbolic analysis allows them
+	SymmetricDecomposition_* NewSparseCholesky
+		(const Square_& a,
+		 const Handle_<CholeskySymbolic_>& symbolic);
+}
@@ -7,6 +7,7 @@
 #include "Vectors.h"
 #include "InterpCubic.h"
 #include "Strings.h"
+#include "Algorithms.h"
 
 namespace
 {
@@ -56,3 +57,70 @@ double InverseNCDF(double x, bool precise, bool polish)
 	return retval;
 }
 
+namespace
+{
+	static const double INV_ROOT_2 = 1.0 / sqrt(2.0);
+	static const double ROOT_2PI = sqrt(2.0 * DA::PI);
+
+	// the precise kernel is branch-light and free of virtual calls, so that loops over it can be vectorized
+		// the fast kernel is the scalar spline, so that array and scalar results agree
+
+	inline double NcdfPrecise(double x)
+	{
+		return 0.5 * erfc(-x * INV_ROOT_2);
+	}
+
+	// NCDF(z) - p; in the upper tail we compare complements (1 - p is exact) to avoid cancellation
+	inline double PreciseError(double z, double p)
+	{
+		return p > 0.5 ? (1.0 - p) - NcdfPrecise(-z) : NcdfPrecise(z) - p;
+	}
+
+	// Acklam's rational approximation, for p in (0, 1)
+	inline double InverseNcdfRational(double p)
+	{
+		static const double A1 = -3.969683028665376e+01, A2 = 2.209460984245205e+02, A3 = -2.759285104469687e+02, A4 = 1.383577518672690e+02, A5 = -3.066479806614716e+01, A6 = 2.506628277459239e+00;
+		static const double B1 = -5.447609879822406e+01, B2 = 1.615858368580409e+02, B3 = -1.556989798598866e+02, B4 = 6.680131188771972e+01, B5 = -1.328068155288572e+01;
+		static const double C1 = -7.784894002430293e-03, C2 = -3.223964580411365e-01, C3 = -2.400758277161838e+00, C4 = -2.549732539343734e+00, C5 = 4.374664141464968e+00, C6 = 2.938163982698783e+00;
+		static const double D1 = 7.784695709041462e-03, D2 = 3.224671290700398e-01, D3 = 2.445134137142996e+00, D4 = 3.754408661907416e+00;
+		static const double P_LOW = 0.02425;
+		const double pTail = Min(p, 1.0 - p);
+		if (pTail < P_LOW)
+		{
+			const double q = sqrt(-2.0 * log(pTail));
+			const double x = (((((C1 * q + C2) * q + C3) * q + C4) * q + C5) * q + C6) / ((((D1 * q + D2) * q + D3) * q + D4) * q + 1.0);
+			return p < 0.5 ? x : -x;
+		}
+		const double q = p - 0.5, r = q * q;
+		return (((((A1 * r + A2) * r + A3) * r + A4) * r + A5) * r + A6) * q / (((((B1 * r + B2) * r + B3) * r + B4) * r + B5) * r + 1.0);
+	}
+}
+
+void NCDF(const Vector_<>& x, Vector_<>* dst, bool precise)
+{
+	dst->Resize(x.size());
+	if (precise)
+		Transform(x, NcdfPrecise, dst);
+	else
+		Transform(x, NcdfBySpline, dst);
+}
+
+void InverseNCDF(const Vector_<>& x, Vector_<>* dst, bool precise, bool polish)
+{
+	dst->Resize(x.size());
+	for (int ii = 0; ii < x.size(); ++ii)
+	{
+		assert(x[ii] >= 0.0 && x[ii] <= 1.0);
+		const double p = DA::EPSILON + x[ii] * (1.0 - 2.0 * DA::EPSILON);	// as in the scalar version
+		double z = InverseNcdfRational(p);
+		// one Halley step takes the rational approximation to full precision, matching the scalar quantile
+		const double u = PreciseError(z, p) * ROOT_2PI * exp(0.5 * z * z);
+		z -= u / (1.0 + 0.5 * z * u);
+		if (polish)
+		{
+			const double err = precise ? PreciseError(z, x[ii]) : NcdfBySpline(z) - x[ii];
+			z -= err * ROOT_2PI * exp(Min(8.0, 0.5 * Square(z)));
+		}
+		(*dst)[ii] = z;
+	}
+}
@@ -1,6 +1,13 @@
 
 #pragma once
 
+#include "Vectors.h"
+
 double NCDF(double x, bool precise = true);
 double InverseNCDF(double x, bool precise = true, bool polish = true);
 
+// array versions; dst may be &x
+	// NCDF is exact to rounding if precise, else the same cubic spline approximation as the scalar version
+	// InverseNCDF refines a rational approximation to full precision, then precise and polish work as in the scalar version
+void NCDF(const Vector_<>& x, Vector_<>* dst, bool precise = true);
+void InverseNCDF(const Vector_<>& x, Vector_<>* dst, bool precise = true, bool polish = true);
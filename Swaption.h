@@ -5,8 +5,14 @@
 
 #include "Trade.h"
 
+class DateTime_;
+
 class Swaption_ : public Trade_
 {
-
+public:
+	// terms which distinguish one swaption from another, e.g. in calibration caches
+	virtual DateTime_ Expiry() const = 0;
+	virtual double Tenor() const = 0;	// of the underlying swap, in years
+	virtual double Strike() const = 0;
 };
 
@@ -65,7 +65,7 @@ const
 	const Swaption_& mve = *euros[iMVE];
 	scoped_ptr<Model_> vhw
 			(VHW::MatchSwaptionHoLee
-					(String_(), YieldCurve(mve.valueCcy_), mve, euroVals[iMVE], VolStart()));
+					(_env, String_(), YieldCurve(mve.valueCcy_), mve, euroVals[iMVE], VolStart()));
 	return vhw->ForTrade(_env, underlying);	// just returns itself, a VHW is also an SDE
 }
 
@@ -0,0 +1,107 @@
+
+#include "Platform.h"
+#include "SwaptionVolCube.h"
+#include "Strict.h"
+
+#include "Algorithms.h"
+#include "Functionals.h"
+#include "Exceptions.h"
+#include "Archive.h"
+#include "Interp.h"
+#include "InterpCubic.h"
+
+namespace
+{
+#include "MG_SwaptionVolCube_v1_Write.inc"
+#include "MG_SwaptionVolCube_v1_Read.inc"
+
+	// lower knot and weight on the upper one, flat beyond the ends
+	pair<int, double> Bracket(const Vector_<>& knots, double x)
+	{
+		if (knots.size() == 1)
+			return make_pair(0, 0.0);
+		const int i = Min(Max(static_cast<int>(UpperBound(knots, x) - knots.begin()) - 1, 0), knots.size() - 2);
+		return make_pair(i, Min(Max((x - knots[i]) / (knots[i + 1] - knots[i]), 0.0), 1.0));
+	}
+
+	Handle_<Interp1_> NewSmile(const String_& name, const Vector_<>& offsets, const Vector_<>& vols)
+	{
+		if (offsets.size() > 2)
+			return Handle_<Interp1_>(Interp::NewCubic(name, offsets, vols, Interp::Boundary_(2, 0.0), Interp::Boundary_(2, 0.0)));
+		return Handle_<Interp1_>(new Interp1Linear_(name, offsets, vols));
+	}
+
+	Storable_* SwaptionVolCube_v1::Reader_::Build() const
+	{
+		return new SwaptionVolCube_(name_, expiries_, tenors_, offsets_, vols_);
+	}
+}	// leave local
+
+SwaptionVolCube_::SwaptionVolCube_
+	(const String_& name,
+	 const Vector_<>& expiries,
+	 const Vector_<>& tenors,
+	 const Vector_<>& offsets,
+	 const Matrix_<>& vols)
+	:
+Storable_("SwaptionVolCube", name),
+expiries_(expiries),
+tenors_(tenors),
+offsets_(offsets),
+vols_(vols)
+{
+	REQUIRE(!expiries_.empty() && IsMonotonic(expiries_), "Swaption cube expiries must be increasing");
+	REQUIRE(!tenors_.empty() && IsMonotonic(tenors_), "Swaption cube tenors must be increasing");
+	REQUIRE(offsets_.size() > 1 && IsMonotonic(offsets_), "Swaption cube needs at least two increasing strike offsets");
+	REQUIRE(vols_.Rows() == expiries_.size() * tenors_.size() && vols_.Cols() == offsets_.size(), "Swaption cube vols must have a row per node and a column per offset");
+	for (int ii = 0; ii < vols_.Rows(); ++ii)
+		smiles_.push_back(NewSmile(name, offsets_, Copy(vols_.Row(ii))));
+}
+
+void SwaptionVolCube_::Write(Archive::Store_& dst) const
+{
+	SwaptionVolCube_v1::XWrite(dst, name_, expiries_, tenors_, offsets_, vols_);
+}
+
+SwaptionVolCube_::Point_ SwaptionVolCube_::At(double expiry, double tenor) const
+{
+	const auto e = Bracket(expiries_, expiry), t = Bracket(tenors_, tenor);
+	const int nT = tenors_.size();
+	const int eHi = Min(e.first + 1, expiries_.size() - 1), tHi = Min(t.first + 1, nT - 1);
+	Point_ retval;
+	retval.node_[0] = e.first * nT + t.first;
+	retval.node_[1] = e.first * nT + tHi;
+	retval.node_[2] = eHi * nT + t.first;
+	retval.node_[3] = eHi * nT + tHi;
+	retval.weight_[0] = (1.0 - e.second) * (1.0 - t.second);
+	retval.weight_[1] = (1.0 - e.second) * t.second;
+	retval.weight_[2] = e.second * (1.0 - t.second);
+	retval.weight_[3] = e.second * t.second;
+	return retval;
+}
+
+double SwaptionVolCube_::Vol(const Point_& point, double offset) const
+{
+	const double x = Min(Max(offset, offsets_.front()), offsets_.back());
+	double retval = 0.0;
+	for (int ii = 0; ii < 4; ++ii)
+		if (point.weight_[ii] != 0.0)
+			retval += point.weight_[ii] * (*smiles_[point.node_[ii]])(x);
+	return retval;
+}
+
+void SwaptionVolCube_::Vols(const Point_& point, const Vector_<>& offsets, Vector_<>* vols) const
+{
+	const double lo = offsets_.front(), hi = offsets_.back();
+	const Vector_<> x = Apply([&](double o) { return Min(Max(o, lo), hi); }, offsets);
+	vols->Resize(x.size());
+	vols->Fill(0.0);
+	Vector_<> node;
+	for (int ii = 0; ii < 4; ++ii)
+	{
+		if (point.weight_[ii] == 0.0)
+			continue;
+		smiles_[point.node_[ii]]->Evaluate(x, &node);
+		Transform(vols, node, LinearIncrement(point.weight_[ii]));
+	}
+}
@@ -0,0 +1,61 @@
+// swaption vol cube:  a smile at each (expiry, tenor) node, interpolated between nodes
+
+#pragma once
+
+#include "Storable.h"
+#include "Vectors.h"
+#include "Matrix.h"
+
+class Interp1_;
+
+/*IF--------------------------------------------------------------------------
+storable SwaptionVolCube
+	Swaption vols by expiry, tenor and strike offset from the forward
+version 1
+&members
+name is ?string
+expiries is number[]
+	Option expiries in years, increasing
+tenors is number[]
+	Swap tenors in years, increasing
+offsets is number[]
+	Strike minus forward swap rate, increasing
+vols is number[][]
+	Vols with a row for each node, tenors varying fastest, and a column for each offset
+&conditions
+vols.Rows() == expiries.size() * tenors.size()
+	Need one row of vols for each (expiry, tenor) node
+vols.Cols() == offsets.size()
+	Need one column of vols for each strike offset
+-IF-------------------------------------------------------------------------*/
+
+// vols are linear in expiry and tenor between nodes, and flat beyond the outer nodes and strikes
+class SwaptionVolCube_ : public Storable_
+{
+public:
+	// nodes and weights for one (expiry, tenor)
+	struct Point_
+	{
+		int node_[4];
+		double weight_[4];
+	};
+
+	SwaptionVolCube_
+		(const String_& name,
+		 const Vector_<>& expiries,
+		 const Vector_<>& tenors,
+		 const Vector_<>& offsets,
+		 const Matrix_<>& vols);
+	void Write(Archive::Store_& dst) const override;
+
+	Point_ At(double expiry, double tenor) const;	// two binary searches; callers pricing many strikes at one point should keep the result
+	double Vol(const Point_& point, double offset) const;
+	void Vols(const Point_& point, const Vector_<>& offsets, Vector_<>* vols) const;	// a whole strike ladder at one point
+
+	double Vol(double expiry, double tenor, double offset) const { return Vol(At(expiry, tenor), offset); }
+
+private:
+	Vector_<> expiries_, tenors_, offsets_;
+	Matrix_<> vols_;
+	Vector_<Handle_<Interp1_>> smiles_;	// fitted once per node
+};
@@ -1,6 +1,7 @@
 
 #include "Platform.h"
 #include "Underdetermined.h"
+#include <mutex>
 #include "Strict.h"
 
 #include "Functionals.h"
@@ -11,6 +12,7 @@
 #include "Cholesky.h"
 #include "Sparse.h"
 #include "BCG.h"
+#include "Parallel.h"
 
 using namespace Underdetermined;
 
@@ -27,6 +29,53 @@ double Underdetermined::Function_::BumpSize() const
    return 1.0e-4;
 }
 
+namespace
+{
+   // calls task(func, ib) for each bump ib, spreading the bumps over threads if func can be cloned
+      // bumps are claimed one at a time, so uneven costs balance; each running bump borrows an idle clone, and a clone is made only when none is idle
+      // every bump sees the same inputs, so the result does not depend on the number of threads
+   void ForEachBump
+      (const Function_& func,
+       int n_bumps,
+       const std::function<void(const Function_&, int)>& task)
+   {
+      std::unique_ptr<Function_> probe(n_bumps > 1 && Parallel::NumThreads() > 1 ? func.Clone() : nullptr);
+      if (!probe)
+      {
+         for (int ib = 0; ib < n_bumps; ++ib)
+            task(func, ib);
+         return;
+      }
+      std::mutex mutex;
+      Vector_<std::unique_ptr<Function_>> clones;
+      clones.emplace_back(probe.release());
+      Vector_<const Function_*> idle(1, clones[0].get());
+      Parallel::For(n_bumps, [&](int ib)
+      {
+         const Function_* mine = nullptr;
+         {
+            std::lock_guard<std::mutex> l(mutex);
+            if (!idle.empty())
+            {
+               mine = idle.back();
+               idle.pop_back();
+            }
+         }
+         if (!mine)
+         {
+            std::unique_ptr<Function_> clone(func.Clone());
+            REQUIRE(clone, "Function clone failed in parallel gradient");
+            std::lock_guard<std::mutex> l(mutex);
+            mine = clone.get();
+            clones.emplace_back(clone.release());
+         }
+         task(*mine, ib);
+         std::lock_guard<std::mutex> l(mutex);
+         idle.push_back(mine);
+      });
+   }
+}  // leave local
+
 void Underdetermined::Function_::Gradient
    (const Vector_<>& x,
     const Vector_<>& f,
@@ -34,22 +83,96 @@ void Underdetermined::Function_::Gradient
 const
 {
    //   virtual void FFast(const Vector_<>& x, Vector_<>* f) const { *f = F(x); }
-   Vector_<> fBase, fBumped;
+   Vector_<> fBase;
    FFast(x, &fBase);
-   Vector_<> xBumped(x);
    const double dx = BumpSize();
    auto scale = bind2nd(std::multiplies<double>(), 1.0 / dx);
-   const int nx = x.size();
-   j->Resize(f.size(), nx);
-   for (int ix = 0; ix < nx; ++ix)
+   j->Resize(f.size(), x.size());
+   ForEachBump(*this, x.size(), [&](const Function_& func, int ix)
    {
+      Vector_<> xBumped(x), fBumped;
       xBumped[ix] += dx;
-      FFast(xBumped, &fBumped);
+      func.FFast(xBumped, &fBumped);
       fBumped -= fBase;
-	  auto col = j->Col(ix);
+      auto col = j->Col(ix);
       Transform(fBumped, scale, &col);
-      xBumped[ix] = x[ix];
+   });
+}
+
+Underdetermined::Sparsity_::Sparsity_(int n_f, const Vector_<Vector_<int>>& rows_by_column)
+{
+   const int nx = rows_by_column.size();
+   colStart_.Resize(nx + 1);
+   colStart_[0] = 0;
+   Vector_<int> rowCounts(n_f, 0);
+   for (int ix = 0; ix < nx; ++ix)
+   {
+      const Vector_<int> rows = Unique(rows_by_column[ix]);
+      for (auto ir : rows)
+      {
+         REQUIRE(ir >= 0 && ir < n_f, "Jacobian sparsity row index out of range");
+         row_.push_back(ir);
+         ++rowCounts[ir];
+      }
+      colStart_[ix + 1] = row_.size();
+   }
+
+   // transpose
+   rowStart_.Resize(n_f + 1);
+   rowStart_[0] = 0;
+   for (int ir = 0; ir < n_f; ++ir)
+      rowStart_[ir + 1] = rowStart_[ir] + rowCounts[ir];
+   col_.Resize(row_.size());
+   pos_.Resize(row_.size());
+   Vector_<int> next(rowStart_.begin(), rowStart_.end() - 1);
+   for (int ix = 0; ix < nx; ++ix)
+   {
+      for (int p = colStart_[ix]; p < colStart_[ix + 1]; ++p)
+      {
+         const int q = next[row_[p]]++;
+         col_[q] = ix;
+         pos_[q] = p;
+      }
    }
+
+   // greedy coloring of the column intersection graph, densest columns first
+   Vector_<int> order(nx);
+   for (int ix = 0; ix < nx; ++ix)
+      order[ix] = ix;
+   auto count = [&](int ix) { return colStart_[ix + 1] - colStart_[ix]; };
+   Sort(&order, [&](int i, int j) { return count(i) > count(j) || (count(i) == count(j) && i < j); });
+   Vector_<int> color(nx, -1), forbidden;	// forbidden[c] == ix means color c is used by a neighbor of ix
+   for (auto ix : order)
+   {
+      for (int p = colStart_[ix]; p < colStart_[ix + 1]; ++p)
+      {
+         for (int q = rowStart_[row_[p]]; q < rowStart_[row_[p] + 1]; ++q)
+            if (color[col_[q]] >= 0)
+               forbidden[color[col_[q]]] = ix;
+      }
+      int c = 0;
+      while (c < forbidden.size() && forbidden[c] == ix)
+         ++c;
+      if (c == forbidden.size())
+      {
+         forbidden.push_back(-1);
+         byColor_.push_back(Vector_<int>());
+      }
+      color[ix] = c;
+      byColor_[c].push_back(ix);
+   }
+   for (auto& columns : byColor_)
+      Sort(&columns);
+}
+
+Handle_<Sparsity_> Underdetermined::SparsityOf(const Matrix_<>& j)
+{
+   Vector_<Vector_<int>> rows(j.Cols());
+   for (int ir = 0; ir < j.Rows(); ++ir)
+      for (int ix = 0; ix < j.Cols(); ++ix)
+         if (j(ir, ix) != 0.0)
+            rows[ix].push_back(ir);
+   return Handle_<Sparsity_>(new Sparsity_(j.Rows(), rows));
 }
 
 namespace
@@ -103,14 +226,116 @@ namespace
       }
    };
 
+   // Jacobian stored by columns, on a fixed sparsity pattern
+   struct XJSparse_ : Jacobian_
+   {
+      Handle_<Sparsity_> s_;
+      Vector_<> val_;   // in the column order of s_
+      XJSparse_(const Handle_<Sparsity_>& s) : s_(s), val_(s->row_.size(), 0.0) {}
+
+      int Rows() const override { return s_->Rows(); }
+      int Columns() const override { return s_->Columns(); }
+
+      void DivideRows(const Vector_<>& tol) override
+      {
+         for (int p = 0; p < val_.size(); ++p)
+            val_[p] /= tol[s_->row_[p]];
+      }
+
+      Vector_<> MultiplyRight(const Vector_<>& t) const override
+      {
+         Vector_<> retval(Columns());
+         for (int ix = 0; ix < Columns(); ++ix)
+         {
+            double sum = 0.0;
+            for (int p = s_->colStart_[ix]; p < s_->colStart_[ix + 1]; ++p)
+               sum += val_[p] * t[s_->row_[p]];
+            retval[ix] = sum;
+         }
+         return retval;
+      }
+      Vector_<> MultiplyLeft(const Vector_<>& dx) const override
+      {
+         Vector_<> retval(Rows(), 0.0);
+         for (int ix = 0; ix < Columns(); ++ix)
+            for (int p = s_->colStart_[ix]; p < s_->colStart_[ix + 1]; ++p)
+               retval[s_->row_[p]] += val_[p] * dx[ix];
+         return retval;
+      }
+
+      // one solve per nonempty row, and inner products only over each row's nonzeros
+      void QForm(const Sparse::SymmetricDecomposition_& w, SquareMatrix_<>* form) const override
+      {
+         const int nf = Rows();
+         form->Resize(nf);
+         Vector_<> row(Columns(), 0.0), wij;
+         for (int ii = 0; ii < nf; ++ii)
+         {
+            const int begin = s_->rowStart_[ii], end = s_->rowStart_[ii + 1];
+            if (begin == end)
+            {
+               for (int jj = 0; jj <= ii; ++jj)
+                  (*form)(ii, jj) = (*form)(jj, ii) = 0.0;
+               continue;
+            }
+            for (int q = begin; q < end; ++q)
+               row[s_->col_[q]] = val_[s_->pos_[q]];
+            w.Solve(row, &wij);
+            for (int q = begin; q < end; ++q)
+               row[s_->col_[q]] = 0.0;
+            for (int jj = 0; jj <= ii; ++jj)
+            {
+               double sum = 0.0;
+               for (int q = s_->rowStart_[jj]; q < s_->rowStart_[jj + 1]; ++q)
+                  sum += val_[s_->pos_[q]] * wij[s_->col_[q]];
+               (*form)(ii, jj) = (*form)(jj, ii) = sum;
+            }
+         }
+      }
+
+      // Schubert's update:  the Broyden update applied row by row, restricted to each row's nonzeros
+      void SecantUpdate(const Vector_<>& dx, const Vector_<>& df) override
+      {
+         for (int ii = 0; ii < Rows(); ++ii)
+         {
+            double excess = df[ii], x2 = 0.0;
+            for (int q = s_->rowStart_[ii]; q < s_->rowStart_[ii + 1]; ++q)
+            {
+               const double dxj = dx[s_->col_[q]];
+               excess -= val_[s_->pos_[q]] * dxj;
+               x2 += dxj * dxj;
+            }
+            if (IsZero(x2))
+               continue;
+            for (int q = s_->rowStart_[ii]; q < s_->rowStart_[ii + 1]; ++q)
+               val_[s_->pos_[q]] += excess * dx[s_->col_[q]] / x2;
+         }
+      }
+   };
+
+   // unscaled dense copy of a Jacobian, recovered column by column
+   void ExportJacobian(const Jacobian_& j, const Vector_<>& tol, Matrix_<>* dst)
+   {
+      dst->Resize(j.Rows(), j.Columns());
+      Vector_<> unit(j.Columns(), 0.0);
+      for (int ix = 0; ix < j.Columns(); ++ix)
+      {
+         unit[ix] = 1.0;
+         auto col = dst->Col(ix);
+         Transform(j.MultiplyLeft(unit), tol, std::multiplies<double>(), &col);
+         unit[ix] = 0.0;
+      }
+   }
+
    struct XScaledFunc_
    {
       const Vector_<>& tol_;
       const Function_& func_;
       int nEvals_, nRestarts_;
       Matrix_<> jDense_;   // provides memory, if needed, underpinning jacobian structure
+      Handle_<Sparsity_> pattern_;
 
-      XScaledFunc_(const Vector_<>& tol, const Function_& func, const Controls_& controls) : tol_(tol), func_(func), nEvals_(controls.maxEvaluations_), nRestarts_(controls.maxRestarts_) {}
+      XScaledFunc_(const Vector_<>& tol, const Function_& func, const Controls_& controls) : tol_(tol), func_(func), nEvals_(controls.maxEvaluations_), nRestarts_(controls.maxRestarts_), pattern_(func.Sparsity()) {}
 
       Vector_<> F(const Vector_<>& x)
       {
@@ -128,8 +353,16 @@ namespace
             sparse->DivideRows(tol_);
             return sparse;
          }
+         if (!pattern_.Empty())
+         {
+            std::unique_ptr<Jacobian_> retval(func_.ColoredGradient(x, pattern_));
+            retval->DivideRows(tol_);
+            return retval.release();
+         }
          // have to set up dense J
          func_.Gradient(x, f, &jDense_);
+         if (func_.DetectSparsity())
+            pattern_ = SparsityOf(jDense_);
          std::unique_ptr<XJDense_> retval(new XJDense_(jDense_));
          retval->DivideRows(tol_);
          return retval.release();
@@ -227,6 +460,32 @@ namespace
    }
 }  // leave local
 
+Jacobian_* Underdetermined::Function_::ColoredGradient
+   (const Vector_<>& x,
+    const Handle_<Sparsity_>& pattern)
+const
+{
+   REQUIRE(pattern->Columns() == x.size(), "Jacobian sparsity does not match the number of variables");
+   Vector_<> fBase;
+   FFast(x, &fBase);
+   REQUIRE(pattern->Rows() == fBase.size(), "Jacobian sparsity does not match the number of function values");
+   const double dx = BumpSize();
+   std::unique_ptr<XJSparse_> retval(new XJSparse_(pattern));
+   // the columns of one color have disjoint rows, so each color writes disjoint elements of val_
+   ForEachBump(*this, pattern->Colors(), [&](const Function_& func, int ic)
+   {
+      const Vector_<int>& columns = pattern->byColor_[ic];
+      Vector_<> xBumped(x), fBumped;
+      for (auto ix : columns)
+         xBumped[ix] += dx;
+      func.FFast(xBumped, &fBumped);
+      for (auto ix : columns)
+         for (int p = pattern->colStart_[ix]; p < pattern->colStart_[ix + 1]; ++p)
+            retval->val_[p] = (fBumped[pattern->row_[p]] - fBase[pattern->row_[p]]) / dx;
+   });
+   return retval.release();
+}
+
 
 Vector_<> Underdetermined::Find
    (const Function_& func_in,
@@ -234,7 +493,8 @@ Vector_<> Underdetermined::Find
     const Vector_<>& tol,
     const Sparse::SymmetricDecomposition_& w,
     const Controls_& controls,
-    Matrix_<>* eff_j_inv)
+    Matrix_<>* eff_j_inv,
+    Matrix_<>* jacobian)
 {
    // set up the wrapper through which we will call the function
    XScaledFunc_ func(tol, func_in, controls);
@@ -245,6 +505,20 @@ Vector_<> Underdetermined::Find
    SquareMatrix_<> q;
 
    bool approxJ = false, restart = true;
+   if (jacobian && jacobian->Rows() == fOld.size() && jacobian->Cols() == xOld.size())
+   {
+      // a Jacobian from a nearby problem is treated like a secant update, so a failed step falls back to a fresh gradient
+      func.jDense_ = *jacobian;
+      j.reset(new XJDense_(func.jDense_));
+      j->DivideRows(tol);
+      approxJ = true;
+      restart = false;
+   }
+   auto exportJ = [&]()
+   {
+      if (jacobian)
+         ExportJacobian(*j, tol, jacobian);
+   };
    for (;;)
    {
       if (restart)
@@ -261,7 +535,10 @@ Vector_<> Underdetermined::Find
          Transform(xOld, s, std::plus<double>(), &xNew);
          Vector_<> fNew = func.F(xNew);
          if (*MaxElement(fNew) < 1.0 && *MinElement(fNew) > -1.0)
+         {
+            exportJ();
             return xNew;
+         }
 
          const double oldOld = InnerProduct(fOld, fOld);
          const double oldNew = InnerProduct(fOld, fNew);
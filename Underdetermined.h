@@ -59,6 +59,27 @@ namespace Underdetermined
 			(const Vector_<>& dx, const Vector_<>& df) = 0;
 	};
 
+	// structural nonzeros of a Jacobian, with its columns colored so that no two columns of one color share a row
+		// bumping all the columns of a color together then recovers each of them exactly
+	class Sparsity_ : noncopyable
+	{
+	public:
+		// rows_by_column[i_x] lists the i_f which may depend on x[i_x]
+		Sparsity_(int n_f, const Vector_<Vector_<int>>& rows_by_column);
+
+		int Rows() const { return rowStart_.size() - 1; }
+		int Columns() const { return colStart_.size() - 1; }
+		int Colors() const { return byColor_.size(); }
+
+		// by columns:  entries [colStart_[i_x], colStart_[i_x + 1]) lie in rows row_
+		Vector_<int> colStart_, row_;
+		// by rows:  entries [rowStart_[i_f], rowStart_[i_f + 1]) lie in columns col_, and are stored at positions pos_ of the column order
+		Vector_<int> rowStart_, col_, pos_;
+		Vector_<Vector_<int>> byColor_;	// columns of each color
+	};
+	// pattern of the nonzero elements of a dense Jacobian
+	Handle_<Sparsity_> SparsityOf(const Matrix_<>& j);
+
 	class Function_
 	{
 		virtual double BumpSize() const;
@@ -84,6 +105,20 @@ namespace Underdetermined
 			 const Vector_<>& f, 
 			 Matrix_<>* j) 
 		const;
+		// the default dense Gradient bumps columns in parallel if the function can be cloned, so that no copy is used by two bumps at once
+			// otherwise (the default) F and FFast are only ever called from one thread at a time
+		virtual Function_* Clone() const { return nullptr; }
+
+		// sparse Jacobians are computed by ColoredGradient, with one FFast call per color rather than per column
+			// Sparsity() is called once per search; the default returns null, meaning dense or unknown
+			// if there is no declared pattern and DetectSparsity() is true, the pattern is taken from the first dense Jacobian
+				// so an entry which happens to vanish at the first point will be held at zero thereafter
+		virtual Handle_<Sparsity_> Sparsity() const { return Handle_<Sparsity_>(); }
+		virtual bool DetectSparsity() const { return false; }
+		Jacobian_* ColoredGradient
+			(const Vector_<>& x,
+			 const Handle_<Sparsity_>& pattern)
+		const;
 	};
 
 	Vector_<> Find
@@ -92,7 +127,8 @@ namespace Underdetermined
 		 const Vector_<>& tol,
 		 const Sparse::SymmetricDecomposition_& w,   // already decomposed
 		 const Controls_& controls,
-		 Matrix_<>* eff_j_inv = nullptr);
+		 Matrix_<>* eff_j_inv = nullptr,
+		 Matrix_<>* jacobian = nullptr);	// if supplied and the right size, used in place of the first gradient; if supplied, returns the last Jacobian
 
    Vector_<> Approximate
       (const Function_& func_in,
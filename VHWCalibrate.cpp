@@ -7,9 +7,18 @@
 #include "Rootfind.h"
 #include "Semianalytic.h"
 #include "Swaption.h"
+#include "VHWImp.h"
+#include "Discount.h"
+#include "PiecewiseConstant.h"
+#include "SpecialFunctions.h"
+#include "Algorithms.h"
+#include "Numerics.h"
+#include "WarmStart.h"
+#include "YC.h"
 
 Model_* VHW::MatchSwaptionHoLee
-	(const String_& name,
+	(_ENV,
+	 const String_& name,
 	 const Handle_<YieldCurve_>& yc,
 	 const Swaption_& swaption,
 	 double value,
@@ -18,17 +27,157 @@ Model_* VHW::MatchSwaptionHoLee
 	static const int MAX_ITERATIONS = 40;
 	static const PositiveIncreasing_ ToVol(0.01);
 	static const double TOL = 1.0e-8;
-	Brent_ task(0.0, TOL);	// will be mapped to vol of 1%
+	static const double WARM_STEP = 0.01;	// the market rarely moves the vol by more than this fraction between calls
+	const WarmStart::Key_ key = WarmStart::Key_("VHW::MatchSwaptionHoLee") << name << yc->name_ << vol_start
+			<< swaption.Expiry() << swaption.Tenor() << swaption.Strike();
+	auto warm = WarmStart::Recall(_env, key);
+	Brent_ task(warm.Empty() ? 0.0 : warm->x_[0], TOL, warm.Empty() ? 0.0 : WARM_STEP);	// 0.0 will be mapped to vol of 1%
 	Converged_ check(TOL, TOL);
 	std::unique_ptr<Model_> model;
 	for (int ii = 0; ii < MAX_ITERATIONS; ++ii)
 	{
-		const double vol = ToVol(task.NextX());
+		const double x = task.NextX();
+		const double vol = ToVol(x);
 		model.reset(VHW::NewHoLee(name, yc, vol_start, vol));
 		const double price = Semianalytic::Value(nullptr, swaption, *model)[0].second;	// maybe eventually there will be a special-purpose routine for this
 		if (check(task, price - value))
+		{
+			WarmStart::Solution_ solution;
+			solution.x_ = Vector::V1(x);
+			WarmStart::Remember(_env, key, solution);
 			return model.release();	// success
+		}
 	}
 	THROW("Exhausted iterations in Ho-Lee calibration");
 }
 
+namespace
+{
+	// values a swaption as a function of the variance of S to its expiry, with everything else precomputed
+		// under the expiry-forward measure X = S - E[S] is N(0, v), and DF(expiry, T) = Z(T) exp(B(T) X - B(T)^2 v / 2)
+	struct XSwaptionKernel_
+	{
+		double df_;	// discount to expiry
+		bool isPayer_;
+		Vector_<> c_, z_, b_;	// flows to the fixed receiver at start and payment dates, their forward discounts, and B from expiry
+
+		XSwaptionKernel_
+			(const DiscountCurve_& dc,
+			 const VHWImp::Vol_& h_only,
+			 const DateTime_& vol_start,
+			 const VHW::SwaptionFlows_& swaption)
+		:
+		df_(dc(vol_start.Date(), swaption.expiry_.Date())),
+		isPayer_(swaption.isPayer_)
+		{
+			const int n = swaption.payDates_.size();
+			REQUIRE(n > 0 && swaption.accruals_.size() == n, "Swaption must have one accrual per payment date");
+			REQUIRE(swaption.expiry_ <= DateTime_(swaption.start_), "Swaption must start on or after expiry");
+			c_ = Concatenate(Vector::V1(-1.0), Apply([&](double dcf) { return swaption.strike_ * dcf; }, swaption.accruals_));
+			c_.back() += 1.0;
+			const Vector_<Date_> dates = Concatenate(Vector::V1(swaption.start_), swaption.payDates_);
+			z_ = Apply([&](const Date_& d) { return dc(swaption.expiry_.Date(), d); }, dates);
+			const auto integrals = h_only.Integrate(Vector_<DateTime_>(dates.size(), swaption.expiry_), Apply([](const Date_& d) { return DateTime_(d); }, dates));
+			b_ = Apply([](const VHWImp::Integrals_& i) { return i.b_; }, integrals);
+		}
+
+		// Jamshidian:  the swap is worth c_j z_j exp(b_j X - b_j^2 v / 2) summed over flows, which changes sign once, at X*
+		double Value(double var_s) const
+		{
+			static const int MAX_ITERATIONS = 50;
+			auto swapValue = [&](double x, double* dswap)
+			{
+				double retval = 0.0;
+				ASSIGN(dswap, 0.0);
+				for (int jj = 0; jj < c_.size(); ++jj)
+				{
+					const double v = c_[jj] * z_[jj] * exp(b_[jj] * x - 0.5 * Square(b_[jj]) * var_s);
+					retval += v;
+					if (dswap)
+						*dswap += b_[jj] * v;
+				}
+				return retval;
+			};
+			const double forward = InnerProduct(c_, z_);
+			if (var_s <= 0.0)
+				return df_ * Max(0.0, isPayer_ ? -forward : forward);
+
+			// the swap divided by the start flow is increasing and convex in X, so Newton on it converges
+			double xStar = 0.0;
+			for (int ii = 0; ii < MAX_ITERATIONS; ++ii)
+			{
+				double dswap;
+				const double s = swapValue(xStar, &dswap);
+				// d(swap / start)/dX, in units of the start flow's size
+				const double startFlow = z_[0] * exp(b_[0] * xStar - 0.5 * Square(b_[0]) * var_s);
+				const double slope = dswap - b_[0] * s;
+				REQUIRE(slope > 0.0, "Hull-White swaption kernel needs B increasing along the swap");
+				const double dx = -s / slope;
+				xStar += dx;
+				if (fabs(dx) < 1.0e-14 * (1.0 + fabs(xStar)) || IsZero(s / startFlow))
+					break;
+			}
+			const double sd = sqrt(var_s);
+			double receiver = 0.0;
+			for (int jj = 0; jj < c_.size(); ++jj)
+				receiver += c_[jj] * z_[jj] * NCDF(b_[jj] * sd - xStar / sd);
+			return df_ * (isPayer_ ? receiver - forward : receiver);
+		}
+	};
+}	// leave local
+
+VHWImp::Vol_* VHW::MatchSwaptionStrip
+	(const DiscountCurve_& dc,
+	 const DateTime_& vol_start,
+	 const PiecewiseConstant_& h,
+	 const Vector_<SwaptionFlows_>& strip,
+	 const Vector_<>& values)
+{
+	static const int MAX_ITERATIONS = 100;
+	static const double TOL = 1.0e-12;
+	const int n = strip.size();
+	REQUIRE(n > 0, "No swaptions to calibrate to");
+	REQUIRE(values.size() == n, "Swaption values must match swaptions");
+	// B comes from h alone; g is irrelevant until we price
+	std::unique_ptr<PiecewiseConstant_> unit(PWC::NewConstant(1.0, vol_start));
+	std::unique_ptr<VHWImp::Vol_> hOnly(VHWImp::NewVol(vol_start, *unit, h));
+
+	Vector_<DateTime_> knots(1, vol_start);
+	Vector_<> g;
+	double varSofar = 0.0;
+	for (int ii = 0; ii < n; ++ii)
+	{
+		const DateTime_& expiry = strip[ii].expiry_;
+		REQUIRE(expiry > knots.back(), "Swaption expiries must be increasing and after the vol start");
+		const double dt = expiry - knots.back();
+		const XSwaptionKernel_ kernel(dc, *hOnly, vol_start, strip[ii]);
+		auto error = [&](double g_i) { return kernel.Value(varSofar + dt * Square(g_i)) - values[ii]; };
+
+		// value is increasing in the new piece of g
+		pair<double, double> low(0.0, error(0.0)), high(ii > 0 ? Max(g.back(), TOL) : sqrt(DA::EPSILON), 0.0);
+		REQUIRE(low.second <= 0.0, "Swaption value is below what previous expiries imply");
+		int nHunt = 0;
+		for (high.second = error(high.first); high.second < 0.0; high.second = error(high.first))
+		{
+			REQUIRE(++nHunt < MAX_ITERATIONS, "Swaption value is unattainable in Hull-White model");
+			low = high;
+			high.first *= 2.0;
+		}
+		BracketedBrent_ task(low, high, TOL * high.first);
+		Converged_ check(TOL * high.first, TOL * Max(1.0, values[ii]));
+		double gi = high.first;
+		for (int jj = 0; ; ++jj)
+		{
+			REQUIRE(jj < MAX_ITERATIONS, "Exhausted iterations in Hull-White strip calibration");
+			gi = task.NextX();
+			if (check(task, error(gi)))
+				break;
+		}
+		g.push_back(gi);
+		varSofar += dt * Square(gi);
+		knots.push_back(expiry);
+	}
+	knots.pop_back();	// the last piece of g extends indefinitely
+	const PiecewiseConstant_ gPWC(knots, g);
+	return VHWImp::NewVol(vol_start, gPWC, h);
+}
@@ -4,16 +4,47 @@
 #pragma once
 
 #include "VHW.h"
+#include "DateTime.h"
 
 class Swaption_;
+class DiscountCurve_;
+struct PiecewiseConstant_;
+namespace VHWImp
+{
+	class Vol_;
+}
 
 namespace VHW
 {
+	// starts from the vol found by the last calibration with the same name, curve and vol start, if the environment holds a WarmStart::Cache_
 	Model_* MatchSwaptionHoLee
-		(const String_& name,
+		(_ENV,
+		 const String_& name,
 		 const Handle_<YieldCurve_>& yc, 
 		 const Swaption_& swaption, 
 		 double value,
 		 const DateTime_& vol_start);
+
+	// European option to enter a single-curve fixed-for-float swap at expiry
+		// the float leg is worth DF(start) - DF(last payment); the fixed leg pays strike * accrual on each payment date
+	struct SwaptionFlows_
+	{
+		DateTime_ expiry_;
+		Date_ start_;
+		Vector_<Date_> payDates_;
+		Vector_<> accruals_;
+		double strike_;
+		bool isPayer_;
+	};
+
+	// bootstraps g, piecewise constant between successive expiries, to match a strip (e.g. co-terminal or diagonal) of swaption values
+		// with h fixed, a swaption's value depends on g only through the variance of S to its expiry
+		// so each swaption in turn is a one-dimensional search on the newest piece of g, priced without building a model
+	VHWImp::Vol_* MatchSwaptionStrip
+		(const DiscountCurve_& dc,
+		 const DateTime_& vol_start,	// values are discounted to this date
+		 const PiecewiseConstant_& h,
+		 const Vector_<SwaptionFlows_>& strip,	// in increasing order of expiry
+		 const Vector_<>& values);
 }
 
@@ -3,6 +3,7 @@
 #include "VHWImp.h"
 #include "Strict.h"
 
+#include "Exceptions.h"
 #include "Archive.h"
 #include "PiecewiseConstant.h"
 
@@ -25,7 +26,6 @@ H is handle PiecewiseConstant
 namespace
 {
 	typedef VHWImp::Vol_ VHW_Vol_;
-	typedef pair<DateTime_, Piece_> kv_t;
 #include "MG_VHW_Vol_v1_Write.inc"
 #include "MG_VHW_Vol_v1_Read.inc"
 
@@ -41,43 +41,29 @@ namespace
 		return new VHWImp::Vol_(vals, name_);
 	}
 
-	// support Integrate() with a free function
-	void Integrate0
-		(const map<DateTime_, Piece_>& vol,
-		 const DateTime_& to,
-		 double* b,
-		 double* var_s,
-		 double* cov_d_s,
-		 double* var_d)
+	// integrals from the start to knot + dt, given the integrals to the knot
+	VHWImp::Integrals_ Extend(const Piece_& sofar, double dt)
 	{
-		assert(!vol.empty());
-		auto pGE = vol.lower_bound(to);
-		if (pGE == vol.begin())
-		{
-			ASSIGN(b, 0.0); 
-			ASSIGN(var_s, 0.0);
-			ASSIGN(cov_d_s, 0.0);
-			ASSIGN(var_d, 0.0);
-			return;
-		}
-		// if we hit a knot point, we integrate from the previous one rather than use the stored values
-			// thus this function can be used for initialization
-		auto pLT = Previous(vol.upper_bound(to));
-		auto dt = to - pLT->first;
-		const auto& sofar = pLT->second;
 		const double g2 = Square(sofar.g_);
 		const double bMid = sofar.B_ + 0.5 * dt * sofar.h_;
-		ASSIGN(b, sofar.B_ + dt * sofar.h_);
-		ASSIGN(var_s, sofar.varS_ + dt * g2);
-		ASSIGN(cov_d_s, sofar.covDS_ - g2 * dt * bMid);
-		ASSIGN(var_d, sofar.varD_ + g2 * dt * (Square(bMid) + Square(dt * sofar.h_) / 12.0));	// need +1/3 dt^2 h^2; bMid^2 gives only +1/4
+		VHWImp::Integrals_ retval;
+		retval.b_ = sofar.B_ + dt * sofar.h_;
+		retval.varS_ = sofar.varS_ + dt * g2;
+		retval.covDS_ = sofar.covDS_ - g2 * dt * bMid;
+		retval.varD_ = sofar.varD_ + g2 * dt * (Square(bMid) + Square(dt * sofar.h_) / 12.0);	// need +1/3 dt^2 h^2; bMid^2 gives only +1/4
+		return retval;
 	}
 
-	// precompute needed integrals
-	void Initialize(map<DateTime_, Piece_>* vol)
+	// integrals from 'from' to 'to', given integrals from the start to each
+	VHWImp::Integrals_ Difference(const VHWImp::Integrals_& from, const VHWImp::Integrals_& to)
 	{
-		for (auto&& piece : *vol)
-			Integrate0(*vol, piece.first, &piece.second.B_, &piece.second.varS_, &piece.second.covDS_, &piece.second.varD_);
+		VHWImp::Integrals_ retval;
+		retval.b_ = to.b_ - from.b_;
+		retval.varS_ = to.varS_ - from.varS_;
+		// B from the start exceeds B from 'from' by from.b_
+		retval.covDS_ = to.covDS_ - from.covDS_ + from.b_ * retval.varS_;
+		retval.varD_ = to.varD_ - from.varD_ - Square(from.b_) * retval.varS_ + 2 * from.b_ * retval.covDS_;
+		return retval;
 	}
 }
 
@@ -85,10 +71,73 @@ VHWImp::Vol_::Vol_
 	(const map<DateTime_, Piece_>& vol,
 	 const String_& name)
 :
-Storable_("VHWVol", name),
-vol_(vol)
+Storable_("VHWVol", name)
+{
+	REQUIRE(!vol.empty(), "VHW vol needs at least one knot");
+	for (const auto& kv : vol)
+	{
+		Piece_ piece = kv.second;
+		if (pieces_.empty())
+			piece.B_ = piece.varS_ = piece.covDS_ = piece.varD_ = 0.0;
+		else
+		{
+			const Integrals_ sofar = Extend(pieces_.back(), kv.first - knots_.back());
+			piece.B_ = sofar.b_;
+			piece.varS_ = sofar.varS_;
+			piece.covDS_ = sofar.covDS_;
+			piece.varD_ = sofar.varD_;
+		}
+		knots_.push_back(kv.first);
+		pieces_.push_back(piece);
+	}
+}
+
+int VHWImp::Vol_::Locate(const DateTime_& t, int* hint) const
 {
-	Initialize(&vol_);
+	// gallop from the hint, in whichever direction t lies, then bisect the bracket found
+	const int n = knots_.size();
+	int lo = Max(-1, Min(*hint, n - 1)), hi;	// we seek the largest lo with knots_[lo] <= t, treating knots_[-1] as -infinity and knots_[n] as +infinity
+	if (lo < 0 || knots_[lo] <= t)
+	{
+		for (int step = 1; ; step *= 2)
+		{
+			hi = lo + step;
+			if (hi >= n || t < knots_[hi])
+				break;
+			lo = hi;
+		}
+		hi = Min(hi, n);
+	}
+	else
+	{
+		hi = lo;
+		for (int step = 1; ; step *= 2)
+		{
+			lo = hi - step;
+			if (lo < 0 || knots_[lo] <= t)
+				break;
+			hi = lo;
+		}
+		lo = Max(lo, -1);
+	}
+	while (hi - lo > 1)
+	{
+		const int mid = (lo + hi) / 2;
+		(knots_[mid] <= t ? lo : hi) = mid;
+	}
+	*hint = lo;
+	return lo;
+}
+
+VHWImp::Integrals_ VHWImp::Vol_::IntegralsTo(const DateTime_& t, int* hint) const
+{
+	const int i = Locate(t, hint);
+	if (i < 0)
+	{
+		Integrals_ none = { 0.0, 0.0, 0.0, 0.0 };
+		return none;
+	}
+	return Extend(pieces_[i], t - knots_[i]);
 }
 
 void VHWImp::Vol_::Integrate
@@ -100,15 +149,47 @@ void VHWImp::Vol_::Integrate
 	 double* var_d)
 const
 {
-	double b1, b2, vs1, vs2, c1, c2, vd1, vd2;
-	// postponed -- optimize this by not computing unnecessary integrals from zero
-	Integrate0(vol_, from, &b1, &vs1, &c1, &vd1);
-	Integrate0(vol_, to, &b2, &vs2, &c2, &vd2);
-	ASSIGN(b, b2 - b1);
-	ASSIGN(var_s, vs2 - vs1);
-	auto c = c2 - c1 - b1 * (vs2 - vs1);
-	ASSIGN(cov_d_s, c);
-	ASSIGN(var_d, vd2 - vd1 - Square(b1) * (vs2 - vs1) - 2 * b1 * c);
+	int hint = 0;
+	const Integrals_ i1 = IntegralsTo(from, &hint);
+	const Integrals_ retval = Difference(i1, IntegralsTo(to, &hint));
+	ASSIGN(b, retval.b_);
+	ASSIGN(var_s, retval.varS_);
+	ASSIGN(cov_d_s, retval.covDS_);
+	ASSIGN(var_d, retval.varD_);
+}
+
+Vector_<VHWImp::Integrals_> VHWImp::Vol_::Integrate
+	(const Vector_<DateTime_>& from,
+	 const Vector_<DateTime_>& to)
+const
+{
+	REQUIRE(from.size() == to.size(), "Interval starts and ends must have the same size");
+	Vector_<Integrals_> retval(from.size());
+	int hintFrom = 0, hintTo = 0;
+	for (int ii = 0; ii < from.size(); ++ii)
+		retval[ii] = Difference(IntegralsTo(from[ii], &hintFrom), IntegralsTo(to[ii], &hintTo));
+	return retval;
+}
+
+void VHWImp::Vol_::IntegrateGrid
+	(const Vector_<DateTime_>& grid,
+	 Vector_<Integrals_>* steps,
+	 Vector_<Integrals_>* from_start)
+const
+{
+	steps->Resize(grid.size());
+	if (from_start)
+		from_start->Resize(grid.size());
+	int hint = 0;
+	Integrals_ prior = IntegralsTo(VolStart(), &hint);
+	for (int ii = 0; ii < grid.size(); ++ii)
+	{
+		const Integrals_ sofar = IntegralsTo(grid[ii], &hint);
+		(*steps)[ii] = Difference(prior, sofar);
+		if (from_start)
+			(*from_start)[ii] = sofar;
+		prior = sofar;
+	}
 }
 
 void VHWImp::Vol_::Write(Archive::Store_& dst) const
@@ -118,16 +199,27 @@ void VHWImp::Vol_::Write(Archive::Store_& dst) const
 
 Handle_<PiecewiseConstant_> VHWImp::Vol_::G() const
 {
-	return new PiecewiseConstant_
-			(Apply([](const kv_t& kv){ return kv.first; }, vol_),
-			 Apply([](const kv_t& kv){ return kv.second.g_; }, vol_));
+	return new PiecewiseConstant_(knots_, Apply([](const Piece_& p){ return p.g_; }, pieces_));
 }
 
 Handle_<PiecewiseConstant_> VHWImp::Vol_::H() const
 {
-	return new PiecewiseConstant_
-			(Apply([](const kv_t& kv){ return kv.first; }, vol_),
-			 Apply([](const kv_t& kv){ return kv.second.h_; }, vol_));
+	return new PiecewiseConstant_(knots_, Apply([](const Piece_& p){ return p.h_; }, pieces_));
 }
 
-
+VHWImp::Vol_* VHWImp::NewVol
+	(const DateTime_& vol_start,
+	 const PiecewiseConstant_& g,
+	 const PiecewiseConstant_& h)
+{
+	map<DateTime_, Piece_> vals;
+	const Vector_<DateTime_> knots = Unique(Concatenate(Vector::V1(vol_start), Concatenate(g.knotDates_, h.knotDates_)));
+	for (const auto& t : knots)
+	{
+		if (t < vol_start)
+			continue;
+		vals[t].g_ = PWC::F(g, t);
+		vals[t].h_ = PWC::F(h, t);
+	}
+	return new Vol_(vals);
+}
@@ -4,6 +4,7 @@
 #pragma once
 
 #include <map>
+#include "Vectors.h"
 #include "Storable.h"
 #include "DateTime.h"
 
@@ -22,10 +23,24 @@ namespace VHWImp
 		double varD_;
 	};
 
+	// the integrals Piece_ stores, between two arbitrary times
+	struct Integrals_
+	{
+		double b_;
+		double varS_;
+		double covDS_;
+		double varD_;
+	};
+
 	class Vol_ : public Storable_
 	{
-		std::map<DateTime_, Piece_> vol_;
+		// flat storage:  pieces_[i] is in effect from knots_[i], and holds the integrals from VolStart() to knots_[i]
+		Vector_<DateTime_> knots_;
+		Vector_<Piece_> pieces_;
 		void Write(Archive::Store_& dst) const override;
+
+		int Locate(const DateTime_& t, int* hint) const;	// index of the last knot <= t, or -1
+		Integrals_ IntegralsTo(const DateTime_& t, int* hint) const;	// from VolStart()
 	public:
 		Vol_(const std::map<DateTime_, Piece_>& vol,
 			const String_& name = String_());
@@ -39,10 +54,22 @@ namespace VHWImp
 			double* var_d = nullptr)
 			const;
 
+		// many intervals at once; each search starts from the previous query's result, so monotone queries cost O(1) apiece
+		Vector_<Integrals_> Integrate
+			(const Vector_<DateTime_>& from,
+			 const Vector_<DateTime_>& to)
+		const;
+		// integrals over each step of a sorted event-time grid, where step i runs from grid[i - 1] (or VolStart()) to grid[i]
+		void IntegrateGrid
+			(const Vector_<DateTime_>& grid,
+			 Vector_<Integrals_>* steps,
+			 Vector_<Integrals_>* from_start = nullptr)	// from VolStart() to grid[i]
+		const;
+
 		// allow query of data -- these functions allocate and populate the return structure, thus are not very efficient
 		Handle_<PiecewiseConstant_> G() const;
 		Handle_<PiecewiseConstant_> H() const;
-		DateTime_ VolStart() const{ return vol_.begin()->first; }
+		DateTime_ VolStart() const{ return knots_.front(); }
 	};
 
 	Vol_* NewVol
@@ -0,0 +1,147 @@
+
+#include "Platform.h"
+#include "WarmStart.h"
+#include <deque>
+#include <map>
+#include <mutex>
+#include "Strict.h"
+
+#include "Exceptions.h"
+#include "Strings.h"
+#include "DateTime.h"
+#include "Underdetermined.h"
+#include "BFGS.h"
+
+void WarmStart::Key_::Combine(size_t h)
+{
+	hash_ ^= h + 0x9e3779b9 + (hash_ << 6) + (hash_ >> 2);
+}
+
+WarmStart::Key_::Key_(const String_& problem_type)
+	: hash_(0)
+{
+	*this << problem_type;
+}
+
+WarmStart::Key_& WarmStart::Key_::operator<<(int i)
+{
+	Combine(std::hash<int>()(i));
+	return *this;
+}
+
+WarmStart::Key_& WarmStart::Key_::operator<<(double x)
+{
+	Combine(std::hash<double>()(x));
+	return *this;
+}
+
+WarmStart::Key_& WarmStart::Key_::operator<<(const String_& s)
+{
+	Combine(std::hash<std::string>()(std::string(s.begin(), s.end())));
+	return *this;
+}
+
+WarmStart::Key_& WarmStart::Key_::operator<<(const DateTime_& t)
+{
+	return *this << Date::ToExcel(t.Date()) << t.Frac();
+}
+
+namespace
+{
+	class Cache_ : public WarmStart::Cache_
+	{
+		const int maxSize_;
+		mutable std::mutex mutex_;
+		mutable std::map<size_t, Handle_<WarmStart::Solution_>> vals_;
+		mutable std::deque<size_t> order_;	// of first storage
+	public:
+		Cache_(int max_size) : maxSize_(max_size) {}
+
+		Handle_<WarmStart::Solution_> Find(const WarmStart::Key_& key) const override
+		{
+			std::lock_guard<std::mutex> l(mutex_);
+			auto pv = vals_.find(key.Value());
+			return pv == vals_.end() ? Handle_<WarmStart::Solution_>() : pv->second;
+		}
+
+		void Store(const WarmStart::Key_& key, const WarmStart::Solution_& solution) const override
+		{
+			Handle_<WarmStart::Solution_> copy(new WarmStart::Solution_(solution));	// outside the lock
+			std::lock_guard<std::mutex> l(mutex_);
+			auto& dst = vals_[key.Value()];
+			if (dst.Empty())
+				order_.push_back(key.Value());
+			dst = copy;
+			while (static_cast<int>(order_.size()) > maxSize_)
+			{
+				vals_.erase(order_.front());
+				order_.pop_front();
+			}
+		}
+	};
+}	// leave local
+
+WarmStart::Cache_* WarmStart::NewCache(int max_size)
+{
+	REQUIRE(max_size > 0, "Warm-start cache size must be positive");
+	return new ::Cache_(max_size);
+}
+
+Handle_<WarmStart::Solution_> WarmStart::Recall(_ENV, const Key_& key)
+{
+	Handle_<Solution_> retval;
+	auto func = [&](const Environment::Entry_& e)
+	{
+		if (retval.Empty())
+			if (auto cache = dynamic_cast<const Cache_*>(&e))
+				retval = cache->Find(key);
+	};
+	Environment::Iterate(_env, func);
+	return retval;
+}
+
+void WarmStart::Remember(_ENV, const Key_& key, const Solution_& solution)
+{
+	auto func = [&](const Environment::Entry_& e)
+	{
+		if (auto cache = dynamic_cast<const Cache_*>(&e))
+			cache->Store(key, solution);
+	};
+	Environment::Iterate(_env, func);
+}
+
+Vector_<> WarmStart::Find
+	(_ENV,
+	 const Key_& key,
+	 const Underdetermined::Function_& func,
+	 const Vector_<>& guess,
+	 const Vector_<>& tol,
+	 const Sparse::SymmetricDecomposition_& w,
+	 const UnderdeterminedControls_& controls)
+{
+	Solution_ solution;
+	solution.x_ = guess;
+	auto stored = Recall(_env, key);
+	if (!stored.Empty() && stored->x_.size() == guess.size())
+		solution = *stored;	// Find ignores the Jacobian if it is the wrong shape
+	solution.x_ = Underdetermined::Find(func, solution.x_, tol, w, controls, nullptr, &solution.j_);
+	Remember(_env, key, solution);
+	return solution.x_;
+}
+
+void WarmStart::Minimize
+	(_ENV,
+	 const Key_& key,
+	 Vector_<>* x,
+	 const BFGS::Func_& func,
+	 const BFGSControls_& controls,
+	 double* fx)
+{
+	auto stored = Recall(_env, key);
+	if (!stored.Empty() && stored->x_.size() == x->size())
+		*x = stored->x_;
+	BFGS::Minimize(x, func, controls, fx);
+	Solution_ solution;
+	solution.x_ = *x;
+	Remember(_env, key, solution);
+}
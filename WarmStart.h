@@ -0,0 +1,82 @@
+// cache of the results of previous calibrations, used to start the next search nearby
+
+#pragma once
+
+#include "Environment.h"
+#include "Matrix.h"
+
+class String_;
+class DateTime_;
+struct BFGSControls_;
+namespace BFGS
+{
+	class Func_;
+}
+namespace Sparse
+{
+	class SymmetricDecomposition_;
+}
+namespace Underdetermined
+{
+	class Function_;
+}
+struct UnderdeterminedControls_;
+
+namespace WarmStart
+{
+	// identifies a calibration problem by its structure (instruments, dates, model layout)
+		// not by the market values it matches, which move between calls -- that is what makes the stored result a good guess
+		// a collision only costs a poorer starting point
+	class Key_
+	{
+		size_t hash_;
+		void Combine(size_t h);
+	public:
+		explicit Key_(const String_& problem_type);
+		Key_& operator<<(int i);
+		Key_& operator<<(double x);
+		Key_& operator<<(const String_& s);
+		Key_& operator<<(const DateTime_& t);
+		size_t Value() const { return hash_; }
+	};
+
+	struct Solution_
+	{
+		Vector_<> x_;
+		Matrix_<> j_;	// Jacobian near x_, indexed as J[i_f][i_x]; may be empty
+	};
+
+	// environment entry holding solutions by key
+		// entries are seen through const pointers, so storage is const; it is also thread-safe
+	class Cache_ : public Environment::Entry_
+	{
+	public:
+		virtual Handle_<Solution_> Find(const Key_& key) const = 0;	// empty if nothing is stored
+		virtual void Store(const Key_& key, const Solution_& solution) const = 0;
+	};
+	// holds at most max_size solutions, forgetting the oldest first
+	Cache_* NewCache(int max_size = 1000);
+
+	// looks in every cache in the environment; empty if none has the key
+	Handle_<Solution_> Recall(_ENV, const Key_& key);
+	// stores in every cache in the environment
+	void Remember(_ENV, const Key_& key, const Solution_& solution);
+
+	// searches seeded from, and recorded in, the caches in the environment; with no cache, these are the plain searches
+	Vector_<> Find
+		(_ENV,
+		 const Key_& key,
+		 const Underdetermined::Function_& func,
+		 const Vector_<>& guess,	// used if nothing of the right size is stored
+		 const Vector_<>& tol,
+		 const Sparse::SymmetricDecomposition_& w,
+		 const UnderdeterminedControls_& controls);
+
+	void Minimize
+		(_ENV,
+		 const Key_& key,
+		 Vector_<>* x,	// on input, the guess used if nothing of the right size is stored
+		 const BFGS::Func_& func,
+		 const BFGSControls_& controls,
+		 double* fx = 0);
+}
@@ -2,3 +2,7 @@
 #include "Platform.h"
 #include "YC.h"
 #include "Strict.h"
+
+YieldCurve_::YieldCurve_(const String_& name, const String_& ccy)
+	: Storable_("YieldCurve", name), ccy_(ccy)
+{	}
@@ -0,0 +1,274 @@
+
+#include "Platform.h"
+#include "YCBootstrap.h"
+#include "Strict.h"
+
+#include "Algorithms.h"
+#include "Numerics.h"
+#include "Exceptions.h"
+#include "Date.h"
+#include "YC.h"
+#include "Discount.h"
+#include "YCComponent.h"
+#include "PeriodLength.h"
+#include "Rootfind.h"
+#include "SquareMatrix.h"
+#include "DecompositionsMisc.h"
+#include "Decompositions.h"
+#include "Underdetermined.h"
+
+YC::Bootstrap_::~Bootstrap_()
+{	}
+
+namespace
+{
+	// knots of a fitted curve, shared by its clones
+	struct Knots_
+	{
+		Vector_<> t_;	// days from the anchor to the knots
+		Vector_<> y_;	// -log DF(anchor, knot)
+	};
+
+	// -log DF(anchor, date) is linear in time between knots, so forwards are flat; extended flat beyond the last knot
+		// the knots must not change while the curve is in use, since DiscountCurve_ caches a grid of its values
+	class XFittedDiscount_ : public CurveWithBase_<DiscountCurve_>
+	{
+		Handle_<Knots_> own_;	// empty for a trial curve, which views the bootstrap's working knots
+	public:
+		const Date_ anchor_;
+		const Vector_<>& t_;
+		const Vector_<>& y_;
+		const int live_;	// while bootstrapping, only the first live_ knots are used
+
+		// a view, costing no copies; the bootstrap builds one for each trial
+		XFittedDiscount_(const String_& name, const Date_& anchor, const Vector_<>& t, const Vector_<>& y, int live)
+			: CurveWithBase_<DiscountCurve_>(name, Handle_<DiscountCurve_>()), anchor_(anchor), t_(t), y_(y), live_(live) {}
+		XFittedDiscount_(const String_& name, const Date_& anchor, const Handle_<Knots_>& own, int live)
+			: CurveWithBase_<DiscountCurve_>(name, Handle_<DiscountCurve_>()), own_(own), anchor_(anchor), t_(own->t_), y_(own->y_), live_(live) {}
+
+		double Y(const Date_& date) const
+		{
+			const double t = date - anchor_;
+			const int n = Min(live_, t_.size());
+			if (n == 0)
+				return 0.0;
+			const int i = static_cast<int>(UpperBound(t_, t) - t_.begin());	// knots at or before t
+			if (i == 0)
+				return y_[0] * t / t_[0];
+			const int lo = Min(i, n) - 1;
+			const double tLo = lo > 0 ? t_[lo - 1] : 0.0, yLo = lo > 0 ? y_[lo - 1] : 0.0;
+			const double fwd = (y_[lo] - yLo) / (t_[lo] - tLo);	// within the last live piece, or extending it
+			return y_[lo] + fwd * (t - t_[lo]);
+		}
+
+		double operator()(const Date_& from, const Date_& to) const override
+		{
+			return exp(Y(from) - Y(to));
+		}
+
+		void Write(Archive::Store_&) const override
+		{
+			THROW("Bootstrapped curves are not stored; store their instruments and quotes instead");
+		}
+		XFittedDiscount_* Clone(const String_& new_name, const substitutions_t&) const override
+		{
+			return new XFittedDiscount_(new_name, anchor_, own_.Empty() ? Handle_<Knots_>(new Knots_{ t_, y_ }) : own_, live_);
+		}
+	};
+
+	class XFittedYC_ : public YieldCurve_
+	{
+	public:
+		XFittedDiscount_ dc_;
+		XFittedYC_(const String_& name, const String_& ccy, const Date_& anchor, const Vector_<>& t, const Vector_<>& y, int live)
+			: YieldCurve_(name, ccy), dc_(name, anchor, t, y, live) {}
+		XFittedYC_(const String_& name, const String_& ccy, const Date_& anchor, const Handle_<Knots_>& own)
+			: YieldCurve_(name, ccy), dc_(name, anchor, own, own->t_.size()) {}
+
+		const DiscountCurve_& Discount(const CollateralType_&) const override { return dc_; }
+		// simple rate with act/365 accrual, consistent with the curve's time measure
+		double FwdLibor(const PeriodLength_& tenor, const Date_& fixing_date) const override
+		{
+			const Date_ end = Date::AddMonths(fixing_date, tenor.Months());
+			return (1.0 / dc_(fixing_date, end) - 1.0) * 365.0 / (end - fixing_date);
+		}
+		void Write(Archive::Store_&) const override
+		{
+			THROW("Bootstrapped curves are not stored; store their instruments and quotes instead");
+		}
+	};
+
+	// instrument errors as a function of all the knot values, for the global Jacobian
+		// a clone shares the instruments, which are only read, so the Jacobian columns are bumped in parallel
+	class XErrors_ : public Underdetermined::Function_
+	{
+		const String_& name_;
+		const String_& ccy_;
+		const Date_& anchor_;
+		const Vector_<>& t_;
+		const Vector_<Handle_<YcInstrument_::Rate_>>& rates_;
+		const Vector_<>& quotes_;
+		double BumpSize() const override { return 1.0e-6; }
+	public:
+		XErrors_
+			(const String_& name,
+			 const String_& ccy,
+			 const Date_& anchor,
+			 const Vector_<>& t,
+			 const Vector_<Handle_<YcInstrument_::Rate_>>& rates,
+			 const Vector_<>& quotes)
+			: name_(name), ccy_(ccy), anchor_(anchor), t_(t), rates_(rates), quotes_(quotes) {}
+
+		Vector_<> F(const Vector_<>& y) const override
+		{
+			const XFittedYC_ trial(name_, ccy_, anchor_, t_, y, y.size());
+			Vector_<> retval(rates_.size());
+			for (int k = 0; k < rates_.size(); ++k)
+				retval[k] = (*rates_[k])(trial) - quotes_[k];
+			return retval;
+		}
+		XErrors_* Clone() const override { return new XErrors_(*this); }
+	};
+
+	class Bootstrap_ : public YC::Bootstrap_
+	{
+		static const int MAX_ITERATIONS = 60;
+		static const int MAX_NEWTON = 20;
+		String_ name_, ccy_;
+		Date_ anchor_;
+		bool global_;
+		Vector_<int> order_;	// order_[k] is the index of the instrument at knot k
+		Vector_<Date_> knots_;
+		Vector_<Handle_<YcInstrument_::Rate_>> rates_;	// by knot
+		Vector_<> t_, y_;	// knot times and values of the trial curve
+		Vector_<> quotes_;	// by knot, as of the last fit
+		Handle_<YieldCurve_> fitted_;
+		std::unique_ptr<SquareMatrixDecomposition_> jInv_;	// global Jacobian, kept across fits until progress stalls
+
+		// prices against a view of the current y_, using its first live knots
+		double Error(int k, int live) const
+		{
+			const XFittedYC_ trial(name_, ccy_, anchor_, t_, y_, live);
+			return (*rates_[k])(trial) - quotes_[k];
+		}
+
+		// solves for y_k with the earlier knots fixed; the instrument at knot k does not see later knots
+		void SolveKnot(int k)
+		{
+			static const double TOL = 1.0e-12;
+			Vector_<>& y = y_;
+			const Vector_<>& t = t_;
+			// guess by extending the previous forward, or from the last fit if we have one
+			double guess = y[k];
+			if (fitted_.Empty())
+				guess = k == 0 ? 0.0 : y[k - 1] + (k > 1 ? (y[k - 1] - y[k - 2]) / (t[k - 1] - t[k - 2]) : y[0] / t[0]) * (t[k] - t[k - 1]);
+			Brent_ task(guess, TOL, 1.0e-4 * Max(1.0, t[k] / 365.0));	// steps of about a basis point
+			Converged_ check(TOL, TOL);
+			for (int ii = 0; ; ++ii)
+			{
+				REQUIRE(ii < MAX_ITERATIONS, "Exhausted iterations bootstrapping yield curve knot at " + Date::ToString(knots_[k]));
+				y[k] = task.NextX();
+				if (check(task, Error(k, k + 1)))
+					break;
+			}
+		}
+
+		// quasi-Newton search on all knots together, for instruments which also see later knots
+			// the full Jacobian is bumped, since an instrument may see any knot; it is recomputed only when progress stalls, so a refit after a small move in quotes usually reuses it
+		void Polish()
+		{
+			static const double TOL = 1.0e-12;
+			const int n = knots_.size();
+			const XErrors_ errors(name_, ccy_, anchor_, t_, rates_, quotes_);
+			Vector_<> step;
+			double errPrev = DA::INFINITY;
+			for (int iNewton = 0; ; ++iNewton)
+			{
+				const Vector_<> err = errors.F(y_);
+				const double errMax = Max(fabs(*MaxElement(err)), fabs(*MinElement(err)));
+				if (errMax < TOL)
+					return;
+				REQUIRE(iNewton < MAX_NEWTON, "Exhausted iterations in global yield curve fit");
+				if (!jInv_ || errMax > 0.5 * errPrev)
+				{
+					Matrix_<> bumped;
+					errors.Gradient(y_, err, &bumped);
+					SquareMatrix_<> j(n);
+					for (int k = 0; k < n; ++k)
+					{
+						auto row = j.Row(k);
+						Copy(bumped.Row(k), &row);
+					}
+					jInv_.reset(LUAsDecomposition(j));
+				}
+				errPrev = errMax;
+				jInv_->SolveLeft(err, &step);
+				y_ -= step;
+			}
+		}
+
+	public:
+		Bootstrap_
+			(const String_& name,
+			 const String_& ccy,
+			 const Date_& anchor,
+			 const Vector_<Handle_<YcInstrument_>>& instruments,
+			 const Handle_<YieldCurve_>& funding_yc,
+			 bool global)
+			: name_(name), ccy_(ccy), anchor_(anchor), global_(global)
+		{
+			const int n = instruments.size();
+			REQUIRE(n > 0, "No instruments to bootstrap");
+			for (int ii = 0; ii < n; ++ii)
+				order_.push_back(ii);
+			Sort(&order_, [&](int i, int j) { return instruments[i]->TimeSpan().second < instruments[j]->TimeSpan().second; });
+			for (auto ii : order_)
+			{
+				const Date_ end = instruments[ii]->TimeSpan().second;
+				REQUIRE(anchor_ < end, "Instrument " + instruments[ii]->Name() + " ends before the curve anchor");
+				REQUIRE(knots_.empty() || knots_.back() < end, "Instruments " + instruments[ii]->Name() + " and another end on the same date");
+				knots_.push_back(end);
+				t_.push_back(end - anchor_);
+				rates_.push_back(instruments[ii]->Precompute(instruments[ii], funding_yc));
+			}
+			y_.Resize(n);
+		}
+
+		Handle_<YieldCurve_> Fit(const Vector_<>& quotes) override
+		{
+			const int n = knots_.size();
+			REQUIRE(quotes.size() == n, "Need one quote per instrument");
+			int first = fitted_.Empty() ? 0 : n;
+			Vector_<> sorted(n);
+			for (int k = 0; k < n; ++k)
+			{
+				sorted[k] = quotes[order_[k]];
+				if (first == n && sorted[k] != quotes_[k])
+					first = k;
+			}
+			if (first == n)
+				return fitted_;
+			quotes_.Swap(&sorted);
+			for (int k = first; k < n; ++k)
+				SolveKnot(k);
+			if (global_)
+				Polish();
+			fitted_.reset(new XFittedYC_(name_, ccy_, anchor_, Handle_<Knots_>(new Knots_{ t_, y_ })));
+			return fitted_;
+		}
+
+		const Vector_<Date_>& Knots() const override { return knots_; }
+	};
+}	// leave local
+
+YC::Bootstrap_* YC::NewBootstrap
+	(const String_& name,
+	 const String_& ccy,
+	 const Date_& anchor,
+	 const Vector_<Handle_<YcInstrument_>>& instruments,
+	 const Handle_<YieldCurve_>& funding_yc,
+	 bool global)
+{
+	NOTE("Setting up yield curve bootstrap");
+	return new ::Bootstrap_(name, ccy, anchor, instruments, funding_yc, global);
+}
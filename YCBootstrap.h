@@ -0,0 +1,33 @@
+// bootstraps yield curves from instrument quotes, and refits them incrementally as quotes change
+
+#pragma once
+
+#include "Vectors.h"
+#include "YCInstrument.h"
+
+class String_;
+class Date_;
+class YieldCurve_;
+
+namespace YC
+{
+	// one knot per instrument, at the end of its TimeSpan; the log discount factor is linear in time between knots
+		// instruments are precomputed once, against the funding curve, so each fit only evaluates their Rate_
+	class Bootstrap_ : noncopyable
+	{
+	public:
+		virtual ~Bootstrap_();
+		// the curve at which each instrument's Rate_ matches its quote (quotes are in the order of the instruments)
+			// refits only from the earliest knot whose quote has changed since the last call
+		virtual Handle_<YieldCurve_> Fit(const Vector_<>& quotes) = 0;
+		virtual const Vector_<Date_>& Knots() const = 0;	// in increasing order
+	};
+
+	Bootstrap_* NewBootstrap
+		(const String_& name,
+		 const String_& ccy,
+		 const Date_& anchor,	// discount factors are 1 here
+		 const Vector_<Handle_<YcInstrument_>>& instruments,	// with distinct TimeSpan end dates
+		 const Handle_<YieldCurve_>& funding_yc,	// passed to Precompute; may be empty for a single-curve fit
+		 bool global = false);	// if set, polish the sequential solution with a quasi-Newton search on all knots together, for instruments which depend on later knots
+}
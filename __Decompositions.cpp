@@ -1,6 +1,7 @@
 
 #include "__Platform.h"
 #include "Eispack.h"
+#include "NearestCorrelation.h"
 
 namespace
 {
@@ -25,7 +26,35 @@ z is number[][]
    {
       Eispack::RS(A, d, z);
    }
+
+/*IF--------------------------------------------------------------------------
+public Correlation_Nearest
+   Find the nearest valid correlation matrix to a symmetric matrix
+&inputs
+A is number[][]
+   &$.Rows() == $.Cols()\$ must be square
+   A symmetric matrix, approximately a correlation matrix
+&optional
+weights is number[]
+   &$.empty() || $.size() == A.Rows()\must have one $ for each row of A
+   The importance of fitting each row/column of A; default is 1.0 for all
+min_eigenvalue is number (0.0)
+   &$ >= 0.0 && $ < 1.0\$ must be in [0, 1)
+   Floor on the eigenvalues of the result
+&outputs
+C is number[][]
+   A positive semidefinite matrix with unit diagonal, close to A
+-IF-------------------------------------------------------------------------*/
+
+   void Correlation_Nearest
+      (const Matrix_<>& A,
+       const Vector_<>& weights,
+       double min_eigenvalue,
+       Matrix_<>* C)
+   {
+      *C = NearestCorrelation(A, weights, min_eigenvalue);
+   }
 }  // leave local
 
 #include "MG_Decompose_Eigen_public.inc"
-
+#include "MG_Correlation_Nearest_public.inc"
@@ -71,6 +71,42 @@ f is handle Interp1
       f->reset(new Interp1Linear_(name, x, z));
    }
 
+/*IF--------------------------------------------------------------------------
+public Smoothing_Lambda_GCV
+   Choose the smoothing weight for Interp1_New_Linear_Smoothed by generalized cross-validation
+&inputs
+x is number[]
+   &IsMonotonic(x)\$ values must be in ascending order
+   The x-values (abcissas)
+ys is number[][]
+   &$.Cols() == x.size()\must have one column of ys for each x
+   The values of f(x), with a row for each function to be smoothed
+lambdas is number[]
+   &!$.empty()\$ must not be empty
+   &AllOf($, IsPositive)\$ must be positive
+   The candidate smoothing weights
+&optional
+fit_weights is number[]
+	&$.empty() || $.size() == x.size()\must have one $ for each x
+	The weight to attach to accuracy of fit for each y_i; default is 1.0 for all
+&outputs
+lambda is number[]
+   The candidate with the best score, for each row of ys
+scores is number[][]
+   The GCV score of each candidate (by column) for each row of ys; smaller is better
+-IF-------------------------------------------------------------------------*/
+
+   void Smoothing_Lambda_GCV
+      (const Vector_<>& x,
+       const Matrix_<>& ys,
+       const Vector_<>& lambdas,
+       const Vector_<>& fit_weights,
+       Vector_<>* lambda,
+       Matrix_<>* scores)
+   {
+      *lambda = Smooth::GCVLambda(x, ys, fit_weights, lambdas, scores);
+   }
+
 /*IF--------------------------------------------------------------------------
 public Interp1_New_Cubic
    Create a cubic-spline interpolator
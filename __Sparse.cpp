@@ -61,9 +61,9 @@ b is number[]
       case SparseType_::Value_::BANDED:
          w.reset(Sparse::NewBandDiagonal(n, nAbove, nBelow));
          break;
-//      case SparseType_::Value_::SLAP:
-//         w.reset(Sparse::NewSLAP(n));
-//         break;
+      case SparseType_::Value_::SLAP:
+         w.reset(Sparse::NewSLAP(n));
+         break;
       default:
          THROW("Invalid sparse matrix type");
       }
@@ -3,6 +3,7 @@
 	// very simple functions to test FFI
 #include "__Platform.h"
 #include <cmath>
+#include "SpecialFunctions.h"
 
 namespace
 {
@@ -41,7 +42,58 @@ Z is number
 			*z = std::tanh(aZ);
 		}
 	}
+
+/*IF--------------------------------------------------------------------------
+public NCDF_ArrayCheck
+	Compares the array NCDF and InverseNCDF with the scalar versions over a dense grid, including the tails
+&optional
+precise is boolean (true)
+	Passed to both versions of each function
+polish is boolean (true)
+	Passed to both versions of InverseNCDF
+&outputs
+ncdf_error is number
+	Largest difference between array and scalar NCDF, relative to the scalar value
+inverse_error is number
+	Largest difference between array and scalar InverseNCDF, times the normal density there (so in probability terms, since the quantile is ill-conditioned in the tails)
+-IF-------------------------------------------------------------------------*/
+
+	void NCDF_ArrayCheck
+		(bool precise,
+		 bool polish,
+		 double* ncdf_error,
+		 double* inverse_error)
+	{
+		Vector_<> x, p, f;
+		for (double xi = -37.5; xi <= 8.5; xi += 0.001)
+			x.push_back(xi);
+		NCDF(x, &f, precise);
+		*ncdf_error = 0.0;
+		for (int ii = 0; ii < x.size(); ++ii)
+		{
+			const double s = NCDF(x[ii], precise);
+			*ncdf_error = Max(*ncdf_error, fabs(f[ii] - s) / Max(s, DA::EPSILON * DA::EPSILON));
+		}
+
+		for (int ii = 1; ii < 100000; ++ii)
+			p.push_back(ii * 1.0e-5);
+		for (double tail = 1.0e-5; tail > DA::EPSILON; tail *= 0.1)
+		{
+			p.push_back(tail);
+			p.push_back(1.0 - tail);
+		}
+		p.push_back(0.0);
+		p.push_back(1.0);
+		InverseNCDF(p, &f, precise, polish);
+		*inverse_error = 0.0;
+		for (int ii = 0; ii < p.size(); ++ii)
+		{
+			const double z = InverseNCDF(p[ii], precise, polish);
+			*inverse_error = Max(*inverse_error, fabs(f[ii] - z) * exp(-0.5 * z * z) / sqrt(2.0 * DA::PI));
+		}
+	}
 }
 
 #include "MG_Lorentz_Add_public.inc"
+#include "MG_NCDF_ArrayCheck_public.inc"
 